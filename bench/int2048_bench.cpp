@@ -0,0 +1,240 @@
+// Microbenchmarks for int2048: every operator, gcd and xgcd at operand sizes
+// from one limb up to --max-digits decimal digits, in balanced and
+// unbalanced shapes.
+// Prints a table and, with --json FILE, writes the same results as JSON so
+// that runs can be compared between releases.
+//
+//   int2048_bench [--max-digits N] [--min-time SECONDS] [--threads T]
+//                 [--filter OP] [--json FILE]
+
+#include "int2048.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using sjtu::int2048;
+
+// Forwards to the default heap and counts the limb buffers allocated, which
+// is what "allocations per op" reports (std::string buffers are not
+// included). It is installed on the main thread only and pool threads
+// allocate from the heap directly, so with --threads above 1 the count
+// would miss their buffers: allocs/op is then reported as "-" (null in the
+// JSON).
+class CountingResource : public sjtu::LimbResource {
+public:
+    long long allocations = 0;
+
+    unsigned *allocate(int n) {
+        allocations++;
+        return new unsigned[n];
+    }
+
+    void deallocate(unsigned *p, int) {
+        delete[] p;
+    }
+};
+
+CountingResource counter;
+
+struct Result {
+    std::string op;
+    std::string shape;
+    long long digits;
+    int limbs;
+    long long iterations;
+    double nsPerOp;
+    double allocsPerOp; // negative when not counted
+};
+
+bool countAllocations = true;
+
+unsigned seed = 20261018;
+
+std::string randomDigits(long long n) {
+    std::string s(n, '0');
+    for (long long i = 0; i < n; i++) {
+        seed = seed * 1103515245 + 12345;
+        s[i] = (seed >> 16) % 10 + '0';
+    }
+    if (s[0] == '0') {
+        s[0] = '1';
+    }
+    return s;
+}
+
+// Limbs needed for n decimal digits.
+int limbsOf(long long digits) {
+    return (int)(digits * 0.10381025296523008) + 1;
+}
+
+double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One untimed run, then enough runs to fill minTime.
+Result measure(const std::string &op, const std::string &shape, long long digits, double minTime,
+               const std::function<void()> &body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    double once = seconds(start);
+    long long iterations = once > 0 ? (long long)(minTime / once) : 1000000;
+    iterations = std::max(1LL, std::min(iterations, 1000000LL));
+    long long allocations = counter.allocations;
+    start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterations; i++) {
+        body();
+    }
+    double total = seconds(start);
+    Result r;
+    r.op = op;
+    r.shape = shape;
+    r.digits = digits;
+    r.limbs = limbsOf(digits);
+    r.iterations = iterations;
+    r.nsPerOp = total * 1e9 / iterations;
+    r.allocsPerOp = countAllocations ? (double)(counter.allocations - allocations) / iterations : -1;
+    return r;
+}
+
+void printRow(const Result &r) {
+    char allocs[32] = "-";
+    if (r.allocsPerOp >= 0) {
+        std::snprintf(allocs, sizeof(allocs), "%.2f", r.allocsPerOp);
+    }
+    std::printf("%-11s %-10s %10lld %9d %10lld %14.1f %10.3f %12.4g %9s\n", r.op.c_str(), r.shape.c_str(),
+                r.digits, r.limbs, r.iterations, r.nsPerOp, r.nsPerOp / r.limbs, r.limbs * 1e9 / r.nsPerOp,
+                allocs);
+    std::fflush(stdout);
+}
+
+bool writeJson(const char *path, const std::vector<Result> &results, long long maxDigits, int threads) {
+    FILE *f = std::fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    const char *simd[] = {"scalar", "sse4.1", "avx2"};
+    std::fprintf(f, "{\n  \"benchmark\": \"int2048\",\n  \"simd\": \"%s\",\n  \"threads\": %d,\n"
+                    "  \"max_digits\": %lld,\n  \"results\": [\n",
+                 simd[sjtu::getSimdLevel()], threads, maxDigits);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        char allocs[32] = "null";
+        if (r.allocsPerOp >= 0) {
+            std::snprintf(allocs, sizeof(allocs), "%.3f", r.allocsPerOp);
+        }
+        std::fprintf(f, "    {\"op\": \"%s\", \"shape\": \"%s\", \"digits\": %lld, \"limbs\": %d, "
+                        "\"iterations\": %lld, \"ns_per_op\": %.1f, \"ns_per_limb\": %.4f, "
+                        "\"limbs_per_sec\": %.6g, \"allocs_per_op\": %s}%s\n",
+                     r.op.c_str(), r.shape.c_str(), r.digits, r.limbs, r.iterations, r.nsPerOp,
+                     r.nsPerOp / r.limbs, r.limbs * 1e9 / r.nsPerOp, allocs,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    long long maxDigits = 1000000;
+    double minTime = 0.2;
+    int threads = 1;
+    const char *filter = nullptr;
+    const char *json = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && !std::strcmp(argv[i], "--max-digits")) {
+            maxDigits = std::atoll(argv[++i]);
+        }
+        else if (i + 1 < argc && !std::strcmp(argv[i], "--min-time")) {
+            minTime = std::atof(argv[++i]);
+        }
+        else if (i + 1 < argc && !std::strcmp(argv[i], "--threads")) {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (i + 1 < argc && !std::strcmp(argv[i], "--filter")) {
+            filter = argv[++i];
+        }
+        else if (i + 1 < argc && !std::strcmp(argv[i], "--json")) {
+            json = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--max-digits N] [--min-time SECONDS] [--threads T] "
+                                 "[--filter OP] [--json FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    sjtu::setThreadCount(threads);
+    countAllocations = sjtu::getThreadCount() == 1;
+    sjtu::ScopedLimbResource scope(&counter);
+
+    std::vector<Result> results;
+    auto run = [&](const std::string &op, const std::string &shape, long long digits,
+                   const std::function<void()> &body) {
+        if (filter && op != filter) {
+            return;
+        }
+        results.push_back(measure(op, shape, digits, minTime, body));
+        printRow(results.back());
+    };
+
+    std::printf("%-11s %-10s %10s %9s %10s %14s %10s %12s %9s\n", "op", "shape", "digits", "limbs", "iters",
+                "ns/op", "ns/limb", "limbs/s", "allocs/op");
+    int2048 sink;
+    // one limb, then powers of ten up to 10^7 digits
+    const long long sizes[] = {9, 100, 1000, 10000, 100000, 1000000, 10000000};
+    for (long long digits : sizes) {
+        if (digits > maxDigits) {
+            break;
+        }
+        std::string text = randomDigits(digits);
+        // unbalanced operands are 1/16 the size
+        long long shortDigits = std::max(1LL, digits / 16);
+        int2048 a(text), b(randomDigits(digits)), c(randomDigits(shortDigits));
+        int2048 wide(randomDigits(2 * digits));
+        int2048 twin = a + 1;
+
+        run("construct", "unary", digits, [&] { sink = int2048(text); });
+        run("copy", "unary", digits, [&] { sink = a; });
+        run("read", "unary", digits, [&] { sink.read(text); });
+        run("write", "unary", digits, [&] {
+            std::ostringstream out;
+            out << a;
+        });
+        std::string bytes = sjtu::serialize(a);
+        run("serialize", "unary", digits, [&] { bytes = sjtu::serialize(a); });
+        run("deserialize", "unary", digits, [&] { sink = sjtu::deserialize(bytes); });
+        run("add", "balanced", digits, [&] { sink = a + b; });
+        run("add", "unbalanced", digits, [&] { sink = a + c; });
+        run("sub", "balanced", digits, [&] { sink = a - b; });
+        run("sub", "unbalanced", digits, [&] { sink = a - c; });
+        run("mul", "balanced", digits, [&] { sink = a * b; });
+        run("mul", "unbalanced", digits, [&] { sink = a * c; });
+        // balanced division: a 2n-digit dividend by an n-digit divisor
+        run("div", "balanced", digits, [&] { sink = wide / a; });
+        run("div", "unbalanced", digits, [&] { sink = a / c; });
+        run("mod", "balanced", digits, [&] { sink = wide % a; });
+        run("mod", "unbalanced", digits, [&] { sink = a % c; });
+        // equal lengths differing in the lowest limb scan every limb
+        run("cmp", "balanced", digits, [&] { sink = int2048(a < twin); });
+        run("cmp", "unbalanced", digits, [&] { sink = int2048(a < c); });
+        // Lehmer below HGCD_THRESHOLD limbs per round, half-GCD above
+        run("gcd", "balanced", digits, [&] { sink = gcd(a, b); });
+        run("gcd", "unbalanced", digits, [&] { sink = gcd(a, c); });
+        int2048 s, t;
+        run("xgcd", "balanced", digits, [&] { sink = xgcd(a, b, s, t); });
+        run("xgcd", "unbalanced", digits, [&] { sink = xgcd(a, c, s, t); });
+    }
+    if (json && !writeJson(json, results, maxDigits, threads)) {
+        std::fprintf(stderr, "cannot write %s\n", json);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+/*
+Time: 2026-10-17
+Test: mul (karatsuba & ntt against schoolbook)
+std Time: 5.00s
+Time Limit: 10.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+
+unsigned seed = 20261017;
+
+int main()
+{
+    // exact comparison with the schoolbook path
+    int len[] = {1000, 1500, 2000, 3000, 5000, 10000, 30000, 100000};
+    for (int i = 0; i < 8; i++)
+    {
+        sjtu::int2048 a(gen(len[i])), b((i & 1 ? "-" : "") + gen(len[i] - i * 37));
+        sjtu::int2048 r = mulSchoolbook(a, b);
+        std::cout << len[i] << ' ' << (a * b == r) << ' ' << (mulKaratsuba(a, b) == r) << ' ' << (mulNtt(a, b) == r) << '\n';
+    }
+    std::string nines(40000, '9');
+    sjtu::int2048 n9(nines);
+    std::cout << "nines " << (n9 * n9 == mulSchoolbook(n9, n9)) << '\n';
+
+    // schoolbook is out of reach here, so check residues instead; decimal
+    // conversion now dominates at these sizes, so the 10^7-digit operands
+    // are grown by multiplication rather than parsed
+    const long long p = 1000000007;
+    sjtu::int2048 a(gen(1000000)), b("-" + gen(999999));
+    sjtu::int2048 c = a * b;
+    std::cout << 1000000 << ' ' << (c % p == (a % p) * (b % p) % p) << '\n';
+    sjtu::int2048 d = c * c, x = d * d, y = x * a;
+    sjtu::int2048 z = x * y;
+    bool ok = d % p == (c % p) * (c % p) % p && x % p == (d % p) * (d % p) % p &&
+              y % p == (x % p) * (a % p) % p && z % p == (x % p) * (y % p) % p;
+    std::cout << 10000000 << ' ' << ok << '\n';
+}
@@ -0,0 +1,53 @@
+/*
+Time: 2026-10-17
+Test: div & mod (knuth, newton & burnikel-ziegler, floor semantics)
+std Time: 0.20s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+
+unsigned seed = 19260817;
+
+int main()
+{
+    // all division kernels must agree on quotient and remainder
+    int len[][2] = {{20, 9}, {100, 50}, {1000, 500}, {3000, 1000}, {5000, 4990}, {8000, 2000}, {12000, 3000}};
+    for (int i = 0; i < 7; i++)
+    {
+        sjtu::int2048 a(gen(len[i][0])), b(gen(len[i][1])), q1, r1, q2, r2, q3, r3;
+        if (i == 4)
+            b = sjtu::int2048(std::string(len[i][1], '9'));
+        absDivmodSchoolbook(a, b, q1, r1);
+        absDivmodNewton(a, b, q2, r2);
+        absDivmodBurnikelZiegler(a, b, q3, r3);
+        std::cout << len[i][0] << ' ' << len[i][1] << ' ' << (q1 == q2) << ' ' << (r1 == r2) << ' '
+                  << (q1 == q3) << ' ' << (r1 == r3) << ' ' << (q1 * b + r1 == a) << '\n';
+    }
+
+    // x == (x / y) * y + x % y with the remainder taking the sign of y,
+    // whichever strategy is selected
+    sjtu::int2048 a(gen(8000)), b(gen(3000));
+    sjtu::DivisionStrategy strategies[] = {sjtu::DIVISION_SCHOOLBOOK, sjtu::DIVISION_NEWTON,
+                                           sjtu::DIVISION_BURNIKEL_ZIEGLER, sjtu::DIVISION_AUTO};
+    for (int k = 0; k < 4; k++)
+    {
+        sjtu::setDivisionStrategy(strategies[k]);
+        for (int sa = 0; sa < 2; sa++)
+            for (int sb = 0; sb < 2; sb++)
+            {
+                sjtu::int2048 x = sa ? -a : a, y = sb ? -b : b;
+                sjtu::int2048 q = x / y, r = x % y;
+                bool sign = (r == 0) || ((r < 0) == (y < 0));
+                bool bound = sb ? (r > y) : (r < y);
+                std::cout << k << ' ' << (q * y + r == x) << ' ' << sign << ' ' << bound << '\n';
+            }
+    }
+    std::cout << sjtu::int2048(10) / 3 << ' ' << sjtu::int2048(-10) / 3 << ' ' << sjtu::int2048(10) / -3 << ' ' << sjtu::int2048(-10) / -3 << '\n';
+    std::cout << sjtu::int2048(10) % 3 << ' ' << sjtu::int2048(-10) % 3 << ' ' << sjtu::int2048(10) % -3 << ' ' << sjtu::int2048(-10) % -3 << '\n';
+    sjtu::int2048 c(gen(600));
+    c %= c;
+    std::cout << c << '\n';
+}
@@ -0,0 +1,30 @@
+/*
+Time: 2026-10-17
+Test: mul & div & mod by long long
+std Time: 0.01s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+
+int main()
+{
+    sjtu::int2048 a("19260817192608171926081719260817192608171926081719260817192608171926081719260817");
+    long long s[] = {1, -1, 7, -7, 10, 10000, 114514, -99999999999999LL, 100000000000000LL, 10000000000000000LL, -9223372036854775807LL};
+    for (int i = 0; i < 11; i++)
+    {
+        for (int sign = 0; sign < 2; sign++)
+        {
+            sjtu::int2048 x = sign ? -a : a, y(s[i]);
+            bool ok = (x * s[i] == x * y) && (s[i] * x == x * y) && (x / s[i] == x / y) && (x % s[i] == x % y);
+            sjtu::int2048 m = x, d = x, r = x;
+            m *= s[i];
+            d /= s[i];
+            r %= s[i];
+            ok = ok && (m == x * y) && (d == x / y) && (r == x % y);
+            std::cout << s[i] << ' ' << ok << ' ' << d << ' ' << r << '\n';
+        }
+    }
+    sjtu::int2048 z;
+    std::cout << z * 5 << ' ' << z / -5 << ' ' << z % 5 << ' ' << sjtu::int2048(-1) / 10 << ' ' << sjtu::int2048(-1) % 10 << '\n';
+}
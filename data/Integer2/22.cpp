@@ -0,0 +1,57 @@
+/*
+Time: 2026-10-17
+Test: read & print (divide-and-conquer decimal conversion)
+std Time: 1.00s
+Time Limit: 5.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <sstream>
+#include <string>
+
+unsigned seed = 998244353;
+
+std::string show(const sjtu::int2048 &x)
+{
+    std::ostringstream os;
+    os << x;
+    return os.str();
+}
+
+int main()
+{
+    // lengths around the nine-digit chunks and the 2000-digit split points
+    int len[] = {1, 8, 9, 10, 18, 19, 20, 1999, 2000, 2001, 3999, 4000, 4001, 8001, 12345, 100000, 300000};
+    for (int i = 0; i < 17; i++)
+    {
+        std::string s = gen(len[i]);
+        sjtu::int2048 a(s), b("-" + s);
+        std::cout << len[i] << ' ' << (show(a) == s) << ' ' << (show(b) == "-" + s) << ' ' << (a + b == 0) << '\n';
+    }
+
+    // runs of zeros force zero padding inside the split
+    std::string z = "1" + std::string(5000, '0') + "7" + std::string(3000, '0');
+    sjtu::int2048 c(z);
+    std::cout << (show(c) == z) << ' ' << (show(c * c) == "1" + std::string(4999, '0') + "14" + std::string(4999, '0') + "49" + std::string(6000, '0')) << '\n';
+
+    // powers of two cross every limb boundary
+    sjtu::int2048 p(1);
+    std::string pow2 = "1";
+    for (int i = 0; i < 300; i++)
+    {
+        p *= 2;
+        int carry = 0;
+        for (int j = pow2.size() - 1; j >= 0; j--)
+        {
+            int d = (pow2[j] - '0') * 2 + carry;
+            pow2[j] = d % 10 + '0';
+            carry = d / 10;
+        }
+        if (carry)
+            pow2 = "1" + pow2;
+    }
+    std::cout << p << ' ' << (show(p) == pow2) << '\n';
+
+    std::cout << sjtu::int2048("-0") << ' ' << sjtu::int2048("000") << ' ' << sjtu::int2048("-000123") << ' ' << sjtu::int2048() << '\n';
+}
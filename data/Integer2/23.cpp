@@ -0,0 +1,53 @@
+/*
+Time: 2026-10-17
+Test: in-place += & -=, move & swap
+std Time: 0.05s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+int main()
+{
+    // every sign combination, including results that cross zero
+    std::string v[] = {"0", "1", "-1", "4294967295", "-4294967296", "18446744073709551616", "-123456789012345678901234567890"};
+    for (int i = 0; i < 7; i++)
+    {
+        for (int j = 0; j < 7; j++)
+        {
+            sjtu::int2048 a(v[i]), b(v[j]), s = a, d = a;
+            s += b;
+            d -= b;
+            std::cout << s << ' ' << d << ' ' << (s - b == a) << ' ' << (d + b == a) << '\n';
+        }
+    }
+
+    // aliasing
+    sjtu::int2048 x("-98765432109876543210");
+    x += x;
+    std::cout << x << ' ';
+    x -= x;
+    std::cout << x << '\n';
+
+    // fibonacci with swap, as in 12.cpp
+    sjtu::int2048 a(0), b(1);
+    for (int i = 0; i < 1000; i++)
+    {
+        a += b;
+        std::swap(a, b);
+    }
+    std::cout << a << '\n';
+
+    // moved values keep their contents
+    std::vector<sjtu::int2048> w;
+    for (int i = 0; i < 100; i++)
+        w.push_back(sjtu::int2048(std::string(i + 1, '9')));
+    sjtu::int2048 m(std::move(w[99]));
+    sjtu::int2048 n;
+    n = std::move(w[98]);
+    swap(m, n);
+    std::cout << (n == sjtu::int2048(std::string(100, '9'))) << ' ' << (m == sjtu::int2048(std::string(99, '9'))) << '\n';
+}
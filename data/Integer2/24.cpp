@@ -0,0 +1,49 @@
+/*
+Time: 2026-10-17
+Test: values around the inline limb capacity
+std Time: 0.05s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+int main()
+{
+    // 2^32k - 1 and 2^32k straddle the inline capacity as k grows
+    sjtu::int2048 p(1), base("4294967296");
+    std::vector<sjtu::int2048> v;
+    for (int k = 0; k < 8; k++)
+    {
+        v.push_back(p - 1);
+        v.push_back(p);
+        v.push_back(-p);
+        p *= base;
+    }
+    for (int i = 0; i < (int)v.size(); i++)
+        std::cout << v[i] << (i % 3 == 2 ? '\n' : ' ');
+
+    // grow past the inline limbs and shrink back into them
+    sjtu::int2048 x = v[9], y = v[21];
+    x += y;
+    x -= y;
+    std::cout << (x == v[9]) << ' ' << x * x << ' ' << (y * y) / y << '\n';
+
+    // swaps and moves between inline and heap storage
+    std::swap(v[0], v[23]);
+    std::swap(v[5], v[22]);
+    sjtu::int2048 m(std::move(v[23]));
+    v[23] = std::move(v[22]);
+    v[22] = m;
+    std::cout << v[0] << ' ' << v[5] << ' ' << v[22] << ' ' << v[23] << '\n';
+
+    // the container reallocates its elements
+    for (int i = 0; i < 1000; i++)
+        v.push_back(sjtu::int2048(i) * sjtu::int2048(i) * sjtu::int2048(i) * sjtu::int2048(i) * sjtu::int2048(i));
+    sjtu::int2048 sum;
+    for (int i = 0; i < (int)v.size(); i++)
+        sum += v[i];
+    std::cout << sum << '\n';
+}
@@ -0,0 +1,55 @@
+/*
+Time: 2026-10-17
+Test: arena limb resource
+std Time: 0.20s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+
+unsigned seed = 1145141919;
+
+int main()
+{
+    sjtu::int2048 a(gen(30000)), b("-" + gen(12000));
+    sjtu::int2048 prod = a * b, quot = a / b, rem = a % b;
+
+    // the same work inside an arena, results copied out before it goes away
+    sjtu::int2048 p2, q2, r2;
+    {
+        sjtu::LimbArena arena(1 << 12);
+        for (int round = 0; round < 3; round++)
+        {
+            sjtu::ScopedLimbResource use(&arena);
+            sjtu::int2048 x(a), y(b);
+            sjtu::int2048 p = x * y, q = x / y, r = x % y;
+            {
+                sjtu::ScopedLimbResource outer(nullptr);
+                p2 = p;
+                q2 = q;
+                r2 = r;
+            }
+            std::cout << (sjtu::getLimbResource() == &arena) << ' ';
+        }
+        arena.release();
+    }
+    std::cout << (sjtu::getLimbResource() == nullptr) << '\n';
+    std::cout << (p2 == prod) << ' ' << (q2 == quot) << ' ' << (r2 == rem) << '\n';
+
+    // values moved out of an arena scope keep the arena's buffer, so they
+    // have to be copied before release; copies made outside never use it
+    sjtu::LimbArena arena;
+    sjtu::int2048 kept;
+    {
+        sjtu::int2048 t;
+        {
+            sjtu::ScopedLimbResource use(&arena);
+            t = a * a;
+        }
+        kept = t;
+    }
+    arena.release();
+    std::cout << (kept == a * a) << ' ' << (kept % 1000000007) << '\n';
+}
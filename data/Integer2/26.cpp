@@ -0,0 +1,63 @@
+/*
+Time: 2026-10-17
+Test: fused product expressions (addmul(acc, a, b), ...)
+std Time: 0.80s
+Time Limit: 3.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <algorithm>
+#include <string>
+
+unsigned seed = 20240817;
+
+int main()
+{
+    // small, karatsuba and ntt sized operands with every sign
+    int len[] = {5, 30, 700, 40000};
+    for (int i = 0; i < 4; i++)
+    {
+        for (int sign = 0; sign < 16; sign++)
+        {
+            sjtu::int2048 a((sign & 1 ? "-" : "") + gen(len[i])), b((sign & 2 ? "-" : "") + gen(len[i] / 2 + 1));
+            sjtu::int2048 c((sign & 4 ? "-" : "") + gen(len[i] + 3)), d((sign & 8 ? "-" : "") + gen(len[i]));
+            sjtu::int2048 ab = a * b, cd = c * d;
+            sjtu::int2048 acc = c, dec = c, neg, sum = ab, diff = ab, zero;
+            addmul(acc, a, b);
+            submul(dec, a, b);
+            submul(neg, a, b);
+            addmul(sum, c, d);
+            submul(diff, c, d);
+            addmul(zero, a, b);
+            submul(zero, b, a);
+            bool ok = (acc == ab + c) && (dec == c - ab) && (neg == -ab) && (sum == ab + cd) &&
+                      (diff == ab - cd) && (zero == 0) &&
+                      (a * b + c == ab + c) && (c - a * b == c - ab) && (a * b - c * d == ab - cd);
+            std::cout << ok;
+        }
+        std::cout << '\n';
+    }
+
+    // the accumulator may also be an operand
+    sjtu::int2048 x("-123456789123456789123456789"), y("987654321987654321");
+    sjtu::int2048 x0 = x;
+    addmul(x, x, y);
+    std::cout << (x == x0 + x0 * y) << ' ';
+    submul(x, y, x);
+    std::cout << x << '\n';
+
+    // products of products and mixed scalar use
+    sjtu::int2048 f(1);
+    for (int i = 1; i <= 30; i++)
+        f = f * sjtu::int2048(i);
+    std::cout << f << ' ' << f * f / f << ' ' << (f * 2) * f % 1000000007 << '\n';
+
+    // operator* returns a plain int2048: it can be used as a value,
+    // deduced by templates and kept in auto variables
+    sjtu::int2048 u("123456789"), v("-987654321"), w("1000");
+    (u * v).print();
+    std::cout << ' ' << std::max(u * v, w) << ' ';
+    auto uvw = u * v * w;
+    std::cout << uvw << '\n';
+}
@@ -0,0 +1,71 @@
+/*
+Time: 2026-10-17
+Test: addmul & submul & divmod
+std Time: 0.05s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+
+unsigned seed = 31415926;
+
+int main()
+{
+    // every sign, with accumulators that are smaller, equal and larger
+    int len[][2] = {{3, 2}, {20, 20}, {40, 300}, {500, 600}};
+    long long s[] = {1, -1, 3, -4294967295LL, 4294967296LL, -9223372036854775807LL};
+    for (int i = 0; i < 4; i++)
+    {
+        for (int sign = 0; sign < 8; sign++)
+        {
+            sjtu::int2048 acc((sign & 1 ? "-" : "") + gen(len[i][0])), x((sign & 2 ? "-" : "") + gen(len[i][1]));
+            sjtu::int2048 y((sign & 4 ? "-" : "") + gen(len[i][1] / 2 + 1));
+            sjtu::int2048 p = acc, m = acc;
+            addmul(p, x, y);
+            submul(m, x, y);
+            bool ok = p == acc + sjtu::int2048(x * y) && m == acc - sjtu::int2048(x * y);
+            for (int k = 0; k < 6; k++)
+            {
+                sjtu::int2048 ps = acc, ms = acc;
+                addmul(ps, x, s[k]);
+                submul(ms, x, s[k]);
+                ok = ok && ps == acc + x * s[k] && ms == acc - x * s[k];
+            }
+            std::cout << ok;
+        }
+        std::cout << '\n';
+    }
+
+    // sign changes inside the single pass, and aliasing
+    sjtu::int2048 a("4294967296"), b(1);
+    submul(b, a, 3);
+    std::cout << b << ' ';
+    addmul(b, b, 2);
+    std::cout << b << ' ';
+    submul(b, b, b);
+    std::cout << b << '\n';
+
+    // divmod agrees with / and % for both forms
+    sjtu::int2048 n(gen(200)), d(gen(70));
+    for (int sign = 0; sign < 4; sign++)
+    {
+        sjtu::int2048 x = sign & 1 ? -n : n, y = sign & 2 ? -d : d, q, r, qs;
+        long long rs;
+        divmod(x, y, q, r);
+        bool ok = q == x / y && r == x % y;
+        for (int k = 0; k < 6; k++)
+        {
+            divmod(x, s[k], qs, rs);
+            ok = ok && qs == x / s[k] && sjtu::int2048(rs) == x % s[k];
+        }
+        std::cout << ok << ' ' << r << '\n';
+    }
+    sjtu::int2048 q;
+    long long r;
+    divmod(sjtu::int2048(-7), 2, q, r);
+    std::cout << q << ' ' << r << ' ';
+    divmod(sjtu::int2048(0), -5, q, r);
+    std::cout << q << ' ' << r << '\n';
+}
@@ -0,0 +1,59 @@
+/*
+Time: 2026-10-17
+Test: pow & powmod & MontgomeryContext
+std Time: 0.30s
+Time Limit: 2.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+
+unsigned seed = 27182818;
+
+int main()
+{
+    std::cout << pow(sjtu::int2048(-3), 41) << ' ' << pow(sjtu::int2048(2), 0) << ' ' << pow(sjtu::int2048(0), 5) << '\n';
+    sjtu::int2048 big = pow(sjtu::int2048("123456789"), 1000);
+    std::cout << big % 1000000007 << '\n';
+
+    // odd moduli below and above the word-by-word threshold, and even ones
+    int len[] = {1, 9, 40, 300, 700, 1300};
+    for (int i = 0; i < 6; i++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            sjtu::int2048 m(gen(len[i]));
+            if (k == 0 && m % 2 == 0)
+                m += 1;
+            if (k == 1 && m % 2 == 1)
+                m += 1;
+            sjtu::int2048 a(gen(len[i] + 5)), e(gen(len[i] / 3 + 2));
+            std::cout << powmod(a, e, m) % 1000000007 << ' ' << powmod(-a, e, m) % 1000000007 << ' ';
+            std::cout << powmod(a, e, -m) % 1000000007 << '\n';
+        }
+    }
+
+    // a modulus past the reduction threshold, with a short exponent
+    sjtu::int2048 lm(gen(2600)), la(gen(2500)), le(gen(60));
+    if (lm % 2 == 0)
+        lm += 1;
+    std::cout << powmod(la, le, lm) % 1000000007 << '\n';
+
+    // context round trips and products
+    sjtu::int2048 m(gen(800)), x(gen(790)), y("-" + gen(805));
+    if (m % 2 == 0)
+        m += 1;
+    sjtu::MontgomeryContext ctx(m);
+    std::cout << (ctx.fromMont(ctx.toMont(x)) == x % m) << ' ' << (ctx.fromMont(ctx.mul(ctx.toMont(x), ctx.toMont(y))) == x * y % m) << ' ';
+    std::cout << (ctx.pow(x, sjtu::int2048(0)) == 1) << ' ' << (ctx.pow(x, sjtu::int2048(3)) == x * x % m * x % m) << '\n';
+
+    // Fermat and Euler on Mersenne primes p = 2^127 - 1 and q = 2^521 - 1
+    sjtu::int2048 p("170141183460469231731687303715884105727"), q("6864797660130609714981900799081393217269435300143305409394463459185543183397656052122559640661454554977296311391480858037121987999716643812574028291115057151");
+    sjtu::int2048 n = p * q, phi = (p - 1) * (q - 1);
+    sjtu::int2048 msg("31415926535897932384626433832795028841971693993751");
+    std::cout << (powmod(msg, p - 1, p) == 1) << ' ' << (powmod(msg, q, q) == msg) << ' ' << (powmod(msg, phi + 1, n) == msg) << ' ';
+    std::cout << powmod(msg, sjtu::int2048(65537), n) % 1000000007 << '\n';
+
+    std::cout << powmod(sjtu::int2048(5), sjtu::int2048(0), sjtu::int2048(1)) << ' ' << powmod(sjtu::int2048(-2), sjtu::int2048(3), sjtu::int2048(-7)) << '\n';
+}
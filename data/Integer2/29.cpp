@@ -0,0 +1,68 @@
+/*
+Time: 2026-10-17
+Test: gcd & lcm & xgcd & modinv (Lehmer and half-GCD)
+std Time: 1.90s
+Time Limit: 5.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <stdexcept>
+#include <string>
+
+unsigned seed = 14142135;
+
+// a s + b t = g together with g | a and g | b proves g = gcd(a, b)
+bool check(const sjtu::int2048 &a, const sjtu::int2048 &b)
+{
+    sjtu::int2048 s, t;
+    sjtu::int2048 g = xgcd(a, b, s, t);
+    return g == gcd(a, b) && a % g == 0 && b % g == 0 && a * s + b * t == g && lcm(a, b) * g == a * b * (a * b < 0 ? -1 : 1);
+}
+
+int main()
+{
+    long long v[][2] = {{12, -18}, {-12, -18}, {0, 5}, {-7, 0}, {0, 0}, {1, 1}, {240, 46}, {-4294967296LL, 65536}};
+    for (int i = 0; i < 8; i++)
+    {
+        sjtu::int2048 a(v[i][0]), b(v[i][1]), s, t;
+        sjtu::int2048 g = xgcd(a, b, s, t);
+        std::cout << gcd(a, b) << ' ' << lcm(a, b) << ' ' << g << ' ' << s << ' ' << t << '\n';
+    }
+
+    // a large common factor, below and above the half-GCD threshold
+    int len[][2] = {{20, 10}, {300, 100}, {1500, 800}, {6000, 2000}, {30000, 10000}};
+    for (int i = 0; i < 5; i++)
+    {
+        sjtu::int2048 c(gen(len[i][1])), a = c * sjtu::int2048(gen(len[i][0])), b = c * sjtu::int2048("-" + gen(len[i][0] - 3));
+        std::cout << len[i][0] << ' ' << check(a, b) << ' ' << check(b, a) << ' ' << check(a, c) << ' ' << (gcd(a, b) % c == 0) << '\n';
+    }
+    sjtu::int2048 x(gen(4000)), y(gen(3990));
+    std::cout << "coprime " << check(x, y) << ' ' << gcd(x * x, y) % 1000000007 << '\n';
+
+    // Fibonacci neighbours give the longest run of unit quotients
+    sjtu::int2048 f0(0), f1(1);
+    for (int i = 0; i < 20000; i++)
+    {
+        f0 += f1;
+        f0.swap(f1);
+    }
+    std::cout << "fib " << gcd(f1, f0) << ' ' << check(f1, f0) << '\n';
+
+    sjtu::int2048 m("1000000007"), big("1" + gen(200));
+    std::cout << modinv(sjtu::int2048(3), m) << ' ' << modinv(sjtu::int2048(-3), m) << ' ' << modinv(sjtu::int2048(3), -m) << ' ';
+    std::cout << (modinv(big, m) * big % m == 1) << ' ' << modinv(sjtu::int2048(5), sjtu::int2048(1)) << '\n';
+    try
+    {
+        modinv(sjtu::int2048(6), sjtu::int2048(9));
+    }
+    catch (const std::domain_error &)
+    {
+        std::cout << "not invertible\n";
+    }
+
+    // about 2 * 10^5 digits, deep in the half-GCD range
+    sjtu::int2048 c(gen(70000)), a = c * sjtu::int2048(gen(130000)), b = c * sjtu::int2048(gen(130000));
+    sjtu::int2048 g = gcd(a, b);
+    std::cout << "large " << (g % c == 0) << ' ' << (gcd(a / g, b / g) == 1) << ' ' << g.len() << '\n';
+}
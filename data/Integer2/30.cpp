@@ -0,0 +1,64 @@
+/*
+Time: 2026-10-17
+Test: isqrt & iroot & isPerfectSquare
+std Time: 0.60s
+Time Limit: 3.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <stdexcept>
+#include <string>
+
+unsigned seed = 17320508;
+
+// r = floor(a^(1/k)) exactly when r^k <= a < (r + 1)^k
+bool check(const sjtu::int2048 &a, unsigned k, const sjtu::int2048 &r)
+{
+    return pow(r, k) <= a && pow(r + 1, k) > a;
+}
+
+int main()
+{
+    for (int i = 0; i < 20; i++)
+        std::cout << isqrt(sjtu::int2048(i)) << (i == 19 ? '\n' : ' ');
+    sjtu::int2048 two("2" + std::string(200, '0'));
+    std::cout << isqrt(two) << '\n';
+    std::cout << iroot(sjtu::int2048(-27), 3) << ' ' << iroot(sjtu::int2048(-28), 3) << ' ' << iroot(sjtu::int2048(1023), 10) << ' ' << iroot(sjtu::int2048(1024), 10) << ' ';
+    std::cout << iroot(sjtu::int2048(5), 1) << ' ' << iroot(sjtu::int2048(0), 7) << ' ' << iroot(sjtu::int2048("1" + std::string(300, '0')), 100) << '\n';
+
+    int len[] = {5, 30, 200, 1000, 5000, 40000};
+    unsigned ks[] = {2, 3, 5, 64, 1000};
+    for (int i = 0; i < 6; i++)
+    {
+        sjtu::int2048 a(gen(len[i]));
+        std::cout << len[i];
+        for (int j = 0; j < 5; j++)
+            std::cout << ' ' << check(a, ks[j], iroot(a, ks[j]));
+        sjtu::int2048 r = isqrt(a);
+        std::cout << ' ' << (r == iroot(a, 2)) << ' ' << r % 1000000007 << '\n';
+    }
+
+    // exact powers and their neighbours
+    sjtu::int2048 b(gen(3000));
+    sjtu::int2048 sq = b * b, cube = sq * b;
+    std::cout << (isqrt(sq) == b) << (isqrt(sq - 1) == b - 1) << (iroot(cube, 3) == b) << (iroot(cube - 1, 3) == b - 1) << (iroot(-cube, 3) == -b) << ' ';
+    std::cout << isPerfectSquare(sq) << isPerfectSquare(sq + 1) << isPerfectSquare(sq - 1) << isPerfectSquare(sjtu::int2048(0)) << isPerfectSquare(sjtu::int2048(-4)) << '\n';
+    int count = 0;
+    for (int i = 0; i <= 10000; i++)
+        count += isPerfectSquare(sjtu::int2048(i));
+    std::cout << count << '\n';
+
+    // 4 * 10^5 digits
+    sjtu::int2048 big(gen(400000)), r = isqrt(big);
+    std::cout << "large " << (r * r <= big && (r + 1) * (r + 1) > big) << ' ' << r % 1000000007 << '\n';
+
+    try
+    {
+        isqrt(sjtu::int2048(-1));
+    }
+    catch (const std::domain_error &)
+    {
+        std::cout << "no real root\n";
+    }
+}
@@ -0,0 +1,58 @@
+/*
+Time: 2026-10-18
+Test: factorial & binomial & product
+std Time: 0.70s
+Time Limit: 3.00s
+*/
+
+#include "int2048.h"
+#include <stdexcept>
+#include <vector>
+
+int main()
+{
+    for (int n = 0; n <= 25; n++)
+        std::cout << sjtu::factorial(n) << (n == 25 ? '\n' : ' ');
+    std::cout << sjtu::factorial(100) << '\n';
+    std::cout << sjtu::binomial(10, 3) << ' ' << sjtu::binomial(10, 0) << ' ' << sjtu::binomial(10, 10) << ' ' << sjtu::binomial(10, 11) << ' ' << sjtu::binomial(10, -1) << ' ';
+    std::cout << sjtu::binomial(-5, 3) << ' ' << sjtu::binomial(-1, 4) << ' ' << sjtu::binomial(0, 0) << '\n';
+    std::cout << sjtu::binomial(1000, 500) << '\n';
+    std::cout << sjtu::binomial(3037000500LL, 2) << ' ' << sjtu::binomial(4000000000000000000LL, 3) << '\n';
+
+    // against running products, with residues for the large ones
+    const long long p = 1000000007;
+    int ns[] = {1000, 4097, 65536, 200000};
+    for (int i = 0; i < 4; i++)
+    {
+        sjtu::int2048 f = sjtu::factorial(ns[i]), slow(1);
+        long long r = 1;
+        for (int k = 2; k <= ns[i]; k++)
+        {
+            r = r * k % p;
+            if (i < 2)
+                slow *= k;
+        }
+        std::cout << ns[i] << ' ' << (f % p == sjtu::int2048(r)) << ' ' << (i >= 2 || f == slow) << ' ' << f.len() << '\n';
+    }
+    sjtu::int2048 b = sjtu::binomial(100000, 30000);
+    std::cout << (b * sjtu::factorial(30000) * sjtu::factorial(70000) == sjtu::factorial(100000)) << '\n';
+
+    // product over various ranges
+    std::vector<long long> v;
+    for (long long i = 1; i <= 30; i++)
+        v.push_back(i * 1000000007);
+    sjtu::int2048 prod = sjtu::product(v.begin(), v.end()), run(1);
+    for (int i = 0; i < 30; i++)
+        run *= v[i];
+    sjtu::int2048 arr[] = {sjtu::int2048(-3), sjtu::int2048("123456789012345678901234567890"), sjtu::int2048(7)};
+    std::cout << (prod == run) << ' ' << sjtu::product(arr, arr + 3) << ' ' << sjtu::product(arr, arr) << ' ' << sjtu::product(std::vector<sjtu::int2048>(1, arr[0])) << '\n';
+
+    try
+    {
+        sjtu::factorial(-1);
+    }
+    catch (const std::domain_error &)
+    {
+        std::cout << "negative factorial\n";
+    }
+}
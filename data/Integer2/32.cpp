@@ -0,0 +1,42 @@
+/*
+Time: 2026-10-18
+Test: multi-threaded mul & div against the serial path
+std Time: 2.70s
+Time Limit: 8.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+
+unsigned seed = 31415926;
+
+int main()
+{
+    std::cout << sjtu::getThreadCount() << '\n';
+
+    // Karatsuba above PARALLEL_THRESHOLD, NTT with split passes, and
+    // divisions built on both
+    int len[] = {12000, 30000, 100000, 400000};
+    int threads[] = {2, 3, 8};
+    for (int i = 0; i < 4; i++)
+    {
+        sjtu::int2048 a(gen(len[i])), b("-" + gen(len[i] - 11)), d(gen(len[i] / 3));
+        sjtu::setThreadCount(1);
+        sjtu::int2048 p = a * b, k = i >= 2 ? p : mulKaratsuba(a, b), q = a / d, r = b % d;
+        std::cout << len[i] << ' ' << p % 1000000007 << ' ' << q % 1000000007;
+        for (int t = 0; t < 3; t++)
+        {
+            sjtu::setThreadCount(threads[t]);
+            std::cout << ' ' << (a * b == p) << (i >= 2 || mulKaratsuba(a, b) == k) << (a / d == q) << (b % d == r);
+        }
+        std::cout << '\n';
+    }
+
+    // nested use: a product whose operands come from parallel products
+    sjtu::setThreadCount(4);
+    sjtu::int2048 x(gen(200000)), y(gen(200000));
+    sjtu::int2048 z = (x * x) * (y * y);
+    sjtu::setThreadCount(1);
+    std::cout << (z == (x * x) * (y * y)) << ' ' << sjtu::getThreadCount() << '\n';
+}
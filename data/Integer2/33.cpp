@@ -0,0 +1,58 @@
+/*
+Time: 2026-10-18
+Test: batchAdd & batchMul & batchDivmod
+std Time: 0.07s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+#include <vector>
+
+unsigned seed = 27182818;
+
+int main()
+{
+    // mixed sizes and signs, so chunks finish at different times
+    const int n = 3000;
+    std::vector<sjtu::int2048> a, b;
+    for (int i = 0; i < n; i++)
+    {
+        int len = i % 100 == 0 ? 3000 : 1 + i % 300;
+        a.push_back(sjtu::int2048((i & 1 ? "-" : "") + gen(len)));
+        b.push_back(sjtu::int2048((i & 2 ? "-" : "") + gen(1 + len / 2)));
+    }
+    int threads[] = {1, 3};
+    for (int t = 0; t < 2; t++)
+    {
+        sjtu::setThreadCount(threads[t]);
+        std::vector<sjtu::int2048> s(n), p(n), q(n), r(n);
+        batchAdd(a.data(), b.data(), s.data(), n);
+        batchMul(a.data(), b.data(), p.data(), n);
+        batchDivmod(a.data(), b.data(), q.data(), r.data(), n);
+        bool ok = true;
+        sjtu::int2048 check(0);
+        for (int i = 0; i < n; i++)
+        {
+            ok = ok && s[i] == a[i] + b[i] && p[i] == a[i] * b[i] && q[i] == a[i] / b[i] && r[i] == a[i] % b[i];
+            check = (check * 31 + p[i] % 1000000007 + q[i] % 1000000007) % 1000000007;
+        }
+        std::cout << threads[t] << ' ' << ok << ' ' << check << '\n';
+
+        // outputs aliasing the inputs of their own index
+        std::vector<sjtu::int2048> x(a), y(b);
+        batchAdd(x.data(), y.data(), y.data(), n);
+        batchMul(x.data(), y.data(), x.data(), n);
+        ok = true;
+        for (int i = 0; i < n; i++)
+            ok = ok && y[i] == s[i] && x[i] == a[i] * s[i];
+        std::vector<sjtu::int2048> d(a);
+        batchDivmod(d.data(), b.data(), d.data() + 0, r.data(), n);
+        for (int i = 0; i < n; i++)
+            ok = ok && d[i] == q[i];
+        batchMul(a.data(), b.data(), p.data(), 0);
+        std::cout << ok << '\n';
+    }
+    sjtu::setThreadCount(1);
+}
@@ -0,0 +1,72 @@
+/*
+Time: 2026-10-18
+Test: limb kernels (every SIMD level against the scalar loops)
+std Time: 0.05s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+#include <vector>
+
+unsigned seed = 31415926;
+
+// 2^(32n) - 1: n limbs of all ones, where every carry runs the whole length
+sjtu::int2048 ones(int n)
+{
+    return (sjtu::int2048(1) << n) - 1;
+}
+
+// sums, differences, comparisons and scalar products of a fixed set of
+// operands, all in one list
+std::vector<sjtu::int2048> run(const std::vector<sjtu::int2048> &v, const std::vector<long long> &m)
+{
+    std::vector<sjtu::int2048> out;
+    for (int i = 0; i < (int)v.size(); i++)
+    {
+        for (int j = 0; j < (int)v.size(); j++)
+        {
+            out.push_back(v[i] + v[j]);
+            out.push_back(v[i] - v[j]);
+            out.push_back((v[i] < v[j]) * 2 + (v[i] == v[j]));
+        }
+        sjtu::int2048 x = v[i];
+        x *= 4294967295LL;
+        out.push_back(x);
+        x *= m[i];
+        out.push_back(x);
+        out.push_back(v[i] * 7);
+    }
+    return out;
+}
+
+int main()
+{
+    std::vector<sjtu::int2048> v;
+    int len[] = {1, 15, 16, 17, 31, 33, 64, 100, 257};
+    for (int i = 0; i < 9; i++)
+    {
+        v.push_back(ones(len[i]));
+        v.push_back(ones(len[i]) + 1);
+        v.push_back(-ones(len[i]) + (long long)next());
+        v.push_back((ones(len[i]) << 3) + ones(3));
+        v.push_back(sjtu::int2048((i & 1 ? "-" : "") + gen(len[i] * 10)));
+    }
+    std::vector<long long> m;
+    for (int i = 0; i < (int)v.size(); i++)
+        m.push_back((long long)next() << 16 | next());
+    sjtu::SimdLevel best = sjtu::getSimdLevel();
+    sjtu::setSimdLevel(sjtu::SIMD_SCALAR);
+    std::vector<sjtu::int2048> expect = run(v, m);
+    sjtu::SimdLevel levels[] = {sjtu::SIMD_SSE41, sjtu::SIMD_AVX2};
+    for (int i = 0; i < 2; i++)
+    {
+        sjtu::setSimdLevel(levels[i]);
+        std::cout << i << ' ' << (run(v, m) == expect) << ' ' << (sjtu::getSimdLevel() <= levels[i]) << '\n';
+    }
+    sjtu::setSimdLevel(best);
+    std::cout << (sjtu::getSimdLevel() == best) << '\n';
+    std::cout << ones(20) + 1 << '\n' << ones(20) - ones(19) << '\n' << ones(17) * 4294967295LL << '\n';
+    std::cout << (ones(40) < ones(40) + 1) << (ones(40) + 1 > ones(40)) << (ones(40) == ones(40)) << '\n';
+}
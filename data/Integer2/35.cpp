@@ -0,0 +1,54 @@
+/*
+Time: 2026-10-18
+Test: operation counters (int2048::stats)
+std Time: 0.05s
+Time Limit: 1.00s
+*/
+
+#define INT2048_STATS
+#include "../build.h"
+#include "gen.h"
+
+unsigned seed = 16180339;
+
+void show()
+{
+    sjtu::int2048Stats s = sjtu::int2048::stats();
+    for (int i = 0; i < sjtu::STAT_KINDS; i++)
+    {
+        const sjtu::StatCounter &c = s.counters[i];
+        std::cout << sjtu::statName(sjtu::StatKind(i)) << ' ' << c.calls << ' ' << c.limbs << ' '
+                  << (c.calls > 0 ? c.cycles > 0 : c.cycles == 0) << '\n';
+    }
+    std::cout << (s.allocations > 0) << ' ' << (s.allocatedBytes >= 4 * s.allocations) << '\n';
+}
+
+int main()
+{
+    std::cout << sjtu::int2048::stats().enabled << '\n';
+    sjtu::int2048 a(gen(90)), b(gen(95)), c(gen(4000)), d(gen(40000)), e(gen(8000));
+    sjtu::int2048::resetStats();
+    show();
+
+    // one call of each operation, then one product and one division per tier
+    sjtu::int2048 x;
+    x.read("-" + gen(300));
+    std::ostringstream out;
+    out << a;
+    x = a + b;
+    x += b;
+    x = a - b;
+    x -= b;
+    x = a * b;
+    x = c * c;
+    x = d * d;
+    x = d / a;
+    x = d / e;
+    sjtu::setDivisionStrategy(sjtu::DIVISION_NEWTON);
+    x = d % c;
+    sjtu::setDivisionStrategy(sjtu::DIVISION_AUTO);
+    show();
+
+    sjtu::int2048::resetStats();
+    show();
+}
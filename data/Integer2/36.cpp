@@ -0,0 +1,117 @@
+/*
+Time: 2026-10-18
+Test: serialize & deserialize & int2048_view
+std Time: 0.05s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+unsigned seed = 14142135;
+
+// counts limb buffers taken while installed
+struct Counter : sjtu::LimbResource
+{
+    int allocations = 0;
+    unsigned *allocate(int n)
+    {
+        allocations++;
+        return new unsigned[n];
+    }
+    void deallocate(unsigned *p, int)
+    {
+        delete[] p;
+    }
+};
+
+void tryDecode(std::string s)
+{
+    try
+    {
+        sjtu::deserialize(s);
+        std::cout << "ok\n";
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cout << e.what() << '\n';
+    }
+}
+
+int main()
+{
+    // round trips, from zero to thousands of limbs
+    std::string lens[] = {"0", "1", "-1", "4294967295", "-4294967296", gen(30), "-" + gen(300), gen(30000)};
+    for (int i = 0; i < 8; i++)
+    {
+        sjtu::int2048 x(lens[i]);
+        std::string s = sjtu::serialize(x);
+        std::cout << s.size() << ' ' << (s.size() == sjtu::serializedSize(x)) << ' ' << (sjtu::deserialize(s) == x) << '\n';
+    }
+
+    // the exact bytes of -2^32
+    std::string s = sjtu::serialize(sjtu::int2048("-4294967296"));
+    for (int i = 0; i < (int)s.size(); i++)
+        printf("%02x", (unsigned char)s[i]);
+    printf("\n");
+    fflush(stdout);
+
+    // malformed encodings
+    tryDecode(s.substr(0, 20));
+    tryDecode("I2KA" + s.substr(4));
+    std::string t = s;
+    t[4] = 2;
+    tryDecode(t);
+    t = s;
+    t[6] = 2;
+    tryDecode(t);
+    t = s;
+    t[20] = 0;
+    tryDecode(t);
+    t = sjtu::serialize(sjtu::int2048(0));
+    t[6] = 1;
+    tryDecode(t);
+    tryDecode(s + "trailing");
+
+    // views over an aligned and a misaligned copy of an encoding
+    sjtu::int2048 big("-" + gen(20000)), other(gen(7000));
+    std::string e = sjtu::serialize(big);
+    std::vector<unsigned> aligned(e.size() / 4 + 1);
+    memcpy(aligned.data(), e.data(), e.size());
+    std::vector<char> shifted(e.size() + 1);
+    memcpy(shifted.data() + 1, e.data(), e.size());
+
+    Counter counter;
+    int allocations;
+    bool same;
+    {
+        sjtu::ScopedLimbResource scope(&counter);
+        sjtu::int2048_view v((const char *)aligned.data(), e.size());
+        sjtu::int2048_view w(v);
+        same = v == big && w == big && v < other && !(other < v) && v != other && w <= v;
+        allocations = counter.allocations;
+        std::cout << v.borrowed() << w.borrowed() << ' ' << same << ' ' << allocations << '\n';
+    }
+    sjtu::int2048_view v((const char *)aligned.data(), e.size());
+    sjtu::int2048_view u(shifted.data() + 1, e.size());
+    std::cout << u.borrowed() << ' ' << (u == v) << '\n';
+
+    // views as operands
+    bool ok = (v + other == big + other) && (v - other == big - other) && (other - v == other - big) &&
+              (v * other == big * other) && (v / other == big / other) && (v % other == big % other) &&
+              (other % v == other % big) && (gcd(v, other) == gcd(big, other)) && (v * 7 == big * 7);
+    sjtu::int2048 y = v;
+    y += v;
+    y -= other * v;
+    ok = ok && y == big + big - other * big;
+    std::cout << ok << '\n';
+
+    // raw limbs: high zero limbs are dropped, zero is nonnegative
+    unsigned limbs[] = {5, 0, 1, 0, 0, 0, 0};
+    sjtu::int2048_view r(limbs, 7, false), z(limbs + 3, 4, false), small(limbs, 1);
+    std::cout << r << ' ' << z << ' ' << small << ' ' << (z == sjtu::int2048(0)) << ' ' << sjtu::serialize(z).size() << '\n';
+}
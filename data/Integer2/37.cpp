@@ -0,0 +1,62 @@
+/*
+Time: 2026-10-18
+Test: mulStreaming & MappedLimbResource
+std Time: 0.50s
+Time Limit: 2.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <string>
+#include <system_error>
+
+unsigned seed = 17320508;
+
+int main()
+{
+    // blockwise products against the single-transform NTT, with blocks from
+    // one limb up to larger than either operand
+    int len[][2] = {{40000, 40000}, {60000, 3000}, {3000, 60000}, {50000, 49000}, {10, 30000}};
+    int block[] = {16, 256, 1024, 4096, 1 << 20};
+    for (int i = 0; i < 5; i++)
+    {
+        sjtu::int2048 a(gen(len[i][0])), b((i & 1 ? "-" : "") + gen(len[i][1]));
+        sjtu::int2048 r = mulNtt(a, b);
+        std::cout << len[i][0] << ' ' << len[i][1];
+        for (int j = 0; j < 5; j++)
+            std::cout << ' ' << (mulStreaming(a, b, block[j]) == r);
+        std::cout << '\n';
+    }
+    sjtu::int2048 one(gen(9)), wide(gen(30000));
+    std::cout << "one " << (mulStreaming(one, wide, 1) == mulNtt(one, wide)) << '\n';
+    std::string nines(30000, '9');
+    sjtu::int2048 n9(nines), zero;
+    std::cout << "nines " << (mulStreaming(n9, n9, 64) == mulNtt(n9, n9)) << '\n';
+    std::cout << "zero " << mulStreaming(n9, zero, 64) << '\n';
+
+    // the same computation with every buffer of 1024 limbs or more mapped
+    sjtu::int2048 a(gen(60000)), b("-" + gen(25000));
+    sjtu::int2048 p = a * b, q = a / b, s = a + b;
+    sjtu::int2048 t = p * p - q;
+    sjtu::MappedLimbResource mapped(".", 1024);
+    {
+        sjtu::ScopedLimbResource scope(&mapped);
+        sjtu::int2048 x(a), y(b);
+        sjtu::int2048 xy = x * y, xq = x / y, xs = x + y;
+        std::cout << "mapped " << (xy == p) << ' ' << (xq == q) << ' ' << (xs == s) << ' '
+                  << (xy * xy - xq == t) << ' ' << (mapped.mappedBytes() > 0) << '\n';
+    }
+    std::cout << "unmapped " << mapped.mappedBytes() << ' ' << (mapped.peakMappedBytes() >= 4096) << '\n';
+
+    sjtu::MappedLimbResource missing("./no-such-directory", 16);
+    try
+    {
+        sjtu::ScopedLimbResource scope(&missing);
+        sjtu::int2048 x(a);
+        std::cout << "no error\n";
+    }
+    catch (const std::system_error &)
+    {
+        std::cout << "system_error " << missing.mappedBytes() << '\n';
+    }
+}
@@ -0,0 +1,54 @@
+/*
+Time: 2026-10-18
+Test: decimal conversion cache under a released arena
+std Time: 1.00s
+Time Limit: 3.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <sstream>
+#include <string>
+
+unsigned seed = 27182818;
+
+int main()
+{
+    // the first conversions of the process build the cached powers of ten
+    // while an arena is installed; they must not end up in the arena
+    std::string text = gen(50000);
+    std::string first;
+    {
+        sjtu::LimbArena arena(1 << 12);
+        {
+            sjtu::ScopedLimbResource use(&arena);
+            sjtu::int2048 x(text);
+            std::ostringstream out;
+            out << x;
+            first = out.str();
+        }
+        arena.release();
+    }
+    std::cout << (first == text) << '\n';
+
+    // reuse the released memory, then convert with the cached powers again
+    std::string filler = gen(50000);
+    sjtu::int2048 y(filler), z(text);
+    std::ostringstream out;
+    out << z << ' ' << y;
+    std::cout << (out.str() == text + ' ' + filler) << '\n';
+
+    // the same with a mapped resource, whose buffers are unmapped on release
+    std::string wide = gen(200000);
+    {
+        sjtu::MappedLimbResource mapped(".", 1024);
+        sjtu::ScopedLimbResource use(&mapped);
+        sjtu::int2048 x(wide);
+        std::ostringstream o;
+        o << x;
+        std::cout << (o.str() == wide) << '\n';
+    }
+    std::ostringstream o;
+    o << sjtu::int2048(wide);
+    std::cout << (o.str() == wide) << '\n';
+}
@@ -0,0 +1,42 @@
+/*
+Time: 2026-10-18
+Test: concurrent decimal conversion
+std Time: 0.30s
+Time Limit: 2.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+unsigned seed = 31415926;
+
+int main()
+{
+    // the threads start together on an empty cache of powers of ten, each
+    // growing it to a different size and printing through it
+    const int threads = 4;
+    std::vector<std::string> text[threads];
+    for (int t = 0; t < threads; t++)
+        for (int len = 3000; len <= 100000; len *= 3)
+            text[t].push_back(gen(len + 1000 * t));
+    int ok[threads] = {};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++)
+        pool.emplace_back([&, t] {
+            for (int round = 0; round < 2; round++)
+                for (int i = (int)text[t].size() - 1; i >= 0; i--)
+                {
+                    std::ostringstream out;
+                    out << sjtu::int2048(text[t][i]);
+                    ok[t] += out.str() == text[t][i];
+                }
+        });
+    for (std::thread &th : pool)
+        th.join();
+    for (int t = 0; t < threads; t++)
+        std::cout << ok[t] << ' ' << text[t].size() * 2 << '\n';
+}
@@ -0,0 +1,90 @@
+/*
+Time: 2026-10-18
+Test: exceptions thrown inside parallel work
+std Time: 0.30s
+Time Limit: 2.00s
+*/
+
+#include "../build.h"
+#include "gen.h"
+#include <atomic>
+#include <new>
+#include <stdexcept>
+
+unsigned seed = 16180339;
+
+// fails its allocation number limit and forwards every other one to the heap
+struct Failing : sjtu::LimbResource
+{
+    int calls = 0;
+    int limit;
+    explicit Failing(int limit) : limit(limit) {}
+    unsigned *allocate(int n)
+    {
+        if (++calls == limit)
+            throw std::bad_alloc();
+        return new unsigned[n];
+    }
+    void deallocate(unsigned *p, int)
+    {
+        delete[] p;
+    }
+};
+
+int main()
+{
+    sjtu::setThreadCount(4);
+
+    // bodies throwing on whichever thread runs them: the caller gets the
+    // exception only after every index is finished or skipped
+    for (int round = 0; round < 200; round++)
+    {
+        std::atomic<int> running(0), ran(0);
+        bool caught = false;
+        try
+        {
+            sjtu::parallelFor(16, [&](int i) {
+                running++;
+                ran++;
+                if (i % 5 == round % 5)
+                {
+                    running--;
+                    throw std::runtime_error("body");
+                }
+                for (volatile int k = 0; k < 1000; k++)
+                    ;
+                running--;
+            });
+        }
+        catch (const std::runtime_error &)
+        {
+            caught = true;
+        }
+        if (!caught || running != 0 || ran < 1 || ran > 16)
+            std::cout << "round " << round << " failed\n";
+    }
+    std::cout << "bodies ok\n";
+
+    // allocation failures on the calling thread in the middle of threaded
+    // NTT products; every one surfaces as bad_alloc and the pool keeps working
+    sjtu::int2048 a(gen(60000)), b(gen(55000));
+    sjtu::int2048 expect = a * b;
+    int failures = 0;
+    for (int limit = 1;; limit++)
+    {
+        Failing failing(limit);
+        try
+        {
+            sjtu::ScopedLimbResource use(&failing);
+            sjtu::int2048 p = a * b;
+            if (p == expect)
+                break;
+            std::cout << "wrong product\n";
+        }
+        catch (const std::bad_alloc &)
+        {
+            failures++;
+        }
+    }
+    std::cout << (failures > 0) << ' ' << (a * b == expect) << '\n';
+}
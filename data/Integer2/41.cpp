@@ -0,0 +1,71 @@
+/*
+Time: 2026-10-18
+Test: mul & div & mod by two-limb long long
+std Time: 0.05s
+Time Limit: 1.00s
+*/
+
+#include "int2048.h"
+#include "gen.h"
+#include <climits>
+#include <string>
+
+unsigned seed = 57721566;
+
+// counts limb buffers taken while installed
+struct Counter : sjtu::LimbResource
+{
+    long long calls = 0;
+    unsigned *allocate(int n)
+    {
+        calls++;
+        return new unsigned[n];
+    }
+    void deallocate(unsigned *p, int)
+    {
+        delete[] p;
+    }
+};
+
+int main()
+{
+    // every scalar against the same value as an int2048, for both signs
+    long long s[] = {10000000000000000LL, -10000000000000000LL, 4294967296LL, -4294967296LL, 4294967297LL,
+                     18446744073LL, 999999999999999999LL, LLONG_MAX, LLONG_MIN, LLONG_MIN + 1};
+    std::string text[] = {"0", "1", "9999999999999999", "10000000000000000", "123456789012345678901234567890",
+                          gen(200), gen(3000)};
+    int ok = 0, total = 0;
+    for (int i = 0; i < 10; i++)
+        for (int j = 0; j < 7; j++)
+            for (int sign = 0; sign < 2; sign++)
+            {
+                sjtu::int2048 x(sign ? "-" + text[j] : text[j]), y(s[i]);
+                sjtu::int2048 m = x, d = x, r = x, q;
+                m *= s[i];
+                d /= s[i];
+                r %= s[i];
+                long long rem;
+                divmod(x, s[i], q, rem);
+                total++;
+                ok += m == x * y && d == x / y && r == x % y && q == d && sjtu::int2048(rem) == r &&
+                      x * s[i] == m && s[i] * x == m && x / s[i] == d && x % s[i] == r;
+            }
+    std::cout << ok << ' ' << total << '\n';
+
+    sjtu::int2048 a("19260817192608171926081719260817192608171926081719260817192608171926081719260817");
+    std::cout << a * 10000000000000000LL << '\n' << a / 10000000000000000LL << '\n' << a % 10000000000000000LL << '\n';
+    std::cout << -a / 10000000000000000LL << ' ' << -a % 10000000000000000LL << '\n';
+
+    // in place: dividing and taking remainders never allocate, and
+    // multiplying at most grows the buffer once
+    sjtu::int2048 x(gen(1000));
+    Counter counter;
+    sjtu::ScopedLimbResource use(&counter);
+    x /= 10000000000000000LL;
+    x %= 999999999999999989LL;
+    long long divs = counter.calls;
+    sjtu::int2048 big(gen(1000));
+    counter.calls = 0;
+    big *= 10000000000000000LL;
+    std::cout << divs << ' ' << (counter.calls <= 1) << '\n';
+}
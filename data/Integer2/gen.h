@@ -0,0 +1,26 @@
+#pragma once
+
+// Random operands for the test cases: a 32-bit LCG whose state, seed, each
+// case defines with a value of its own, so every run of a case sees the
+// same numbers on every platform.
+
+#include <string>
+
+extern unsigned seed;
+
+inline unsigned next()
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+// n random decimal digits, the first one nonzero
+inline std::string gen(int n)
+{
+    std::string s;
+    for (int i = 0; i < n; i++)
+        s += next() % 10 + '0';
+    if (s[0] == '0')
+        s[0] = '1';
+    return s;
+}
@@ -17,11 +17,278 @@
 
 // 请不要使用 using namespace std;
 
+// Beyond these the library uses only standard utility headers (<algorithm>,
+// <climits>, <cmath>, <cstdint>, <cstdlib>, <exception>, <stdexcept>,
+// <string>, <utility>); anything else is included only under a feature
+// macro, and the single-file build (build.h) defines none of them:
+//   INT2048_THREADS  the thread pool behind setThreadCount and batch*
+//   INT2048_SIMD     the SSE4.1 and AVX2 kernels behind setSimdLevel
+//   INT2048_STATS    the operation counters behind int2048::stats()
+//   INT2048_MMAP     MappedLimbResource (POSIX only)
+
 namespace sjtu {
-  static const int DIGIT_NUM = 4;
+  // Magnitudes are stored as little-endian 32-bit binary limbs; decimal
+  // conversion only happens in read() and operator<<. Limb counts are ints:
+  // an operation whose result would exceed INT_MAX limbs (8 GiB, about
+  // 2 * 10^10 decimal digits) throws std::length_error, as does reading more
+  // than INT_MAX decimal digits.
+  static const int LIMB_BITS = 32;
+  // operator* picks its algorithm by the shorter operand's limb count:
+  // schoolbook below KARATSUBA_THRESHOLD, Karatsuba up to NTT_THRESHOLD and
+  // NTT above; with the AVX2 transforms (setSimdLevel) the NTT already takes
+  // over at NTT_AVX2_THRESHOLD. All are measured crossovers (see
+  // mulKaratsuba/mulNtt).
+  static const int KARATSUBA_THRESHOLD = 48;
+  static const int NTT_THRESHOLD = 3072;
+  static const int NTT_AVX2_THRESHOLD = 512;
+  // Products longer than one NTT can hold (2^24 limbs together) are
+  // computed blockwise instead (mulStreaming), in blocks of up to
+  // STREAM_BLOCK limbs, with working memory of about 16 times the shorter
+  // operand that is swept block by block. Every pair of blocks is multiplied
+  // pointwise, so the time grows with the product of the operands' block
+  // counts: out-of-core sizes are practical for one long and one shorter
+  // operand, not for two balanced ones of many blocks each.
+  static const int STREAM_BLOCK = 1 << 20;
+  // With DIVISION_AUTO, operator/ uses Algorithm D until both the divisor and
+  // the quotient reach BZ_THRESHOLD limbs, Burnikel-Ziegler up to a divisor
+  // of NEWTON_THRESHOLD limbs and Newton reciprocal division beyond that.
+  // BZ_BASE and NEWTON_BASE are the sizes at which those recursions stop.
+  // All four are measured crossovers; on 32-bit limbs Burnikel-Ziegler still
+  // beats Newton at 2^18 limbs, so Newton only takes over near the NTT limit.
+  static const int BZ_THRESHOLD = 384;
+  static const int BZ_BASE = 32;
+  static const int NEWTON_THRESHOLD = 1 << 20;
+  static const int NEWTON_BASE = 16;
+  // MontgomeryContext reduces word by word below this many limbs and with
+  // two multiplications by a precomputed inverse above it (measured).
+  static const int MONTGOMERY_THRESHOLD = 256;
+  // With more than one thread (setThreadCount), Karatsuba products of at
+  // least PARALLEL_THRESHOLD limbs run their three half products
+  // concurrently, and NTT products split every transform pass, the
+  // pointwise products and the CRT recombination. Results are identical for
+  // every thread count.
+  static const int PARALLEL_THRESHOLD = 1024;
+  // gcd and xgcd take Lehmer steps until a round can strip this many limbs,
+  // and half-GCD steps from there (measured).
+  static const int HGCD_THRESHOLD = 64;
+
+  // Algorithm used by operator/ and operator%; DIVISION_AUTO picks by size.
+  enum DivisionStrategy {
+    DIVISION_AUTO,
+    DIVISION_SCHOOLBOOK,
+    DIVISION_NEWTON,
+    DIVISION_BURNIKEL_ZIEGLER
+  };
+  void setDivisionStrategy(DivisionStrategy);
+
+  // Process-wide number of threads for large multiplications (and through
+  // them divisions); 1, the default, keeps everything on the calling thread
+  // and 0 means std::thread::hardware_concurrency(). Set it while no
+  // arithmetic is running. Worker threads allocate from the default heap,
+  // never from the caller's LimbResource. Without INT2048_THREADS the count
+  // is always 1 and setThreadCount does nothing.
+  void setThreadCount(int);
+  int getThreadCount();
+
+  // Instruction set of the limb kernels behind addition, subtraction,
+  // comparison and multiplication by a single limb. The best level the CPU
+  // supports is picked at startup. setSimdLevel switches levels, clamped to
+  // what the CPU supports; set it while no arithmetic is running. Every
+  // level gives identical results. Without INT2048_SIMD (or off x86) only
+  // SIMD_SCALAR is supported.
+  enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE41,
+    SIMD_AVX2
+  };
+  void setSimdLevel(SimdLevel);
+  SimdLevel getSimdLevel();
+
+  // Operations and algorithm tiers counted by int2048::stats(). The tiers
+  // nest inside the operations and inside each other (a Burnikel-Ziegler
+  // division runs schoolbook divisions and Karatsuba products), and each
+  // row's cycles include everything its calls ran.
+  enum StatKind {
+    STAT_ADD,
+    STAT_SUB,
+    STAT_MUL,
+    STAT_DIV,
+    STAT_READ,
+    STAT_WRITE,
+    STAT_MUL_SCHOOLBOOK,
+    STAT_MUL_KARATSUBA,
+    STAT_MUL_NTT,
+    STAT_MUL_STREAMING,
+    STAT_DIV_SCHOOLBOOK,
+    STAT_DIV_BURNIKEL_ZIEGLER,
+    STAT_DIV_NEWTON,
+    STAT_KINDS
+  };
+  const char *statName(StatKind);
+
+  // Counters are only kept when the library is compiled with INT2048_STATS
+  // defined; otherwise nothing is counted, enabled is false and every
+  // counter stays zero. limbs adds up the operands' limb counts (the
+  // result's for read), and cycles is TSC ticks on x86 and nanoseconds
+  // elsewhere (recursive calls of one kind are timed once). allocations and
+  // allocatedBytes count the limb buffers LimbVector obtains, from the heap
+  // or a LimbResource.
+  struct StatCounter {
+    long long calls;
+    long long limbs;
+    long long cycles;
+  };
+  struct int2048Stats {
+    bool enabled;
+    StatCounter counters[STAT_KINDS];
+    long long allocations;
+    long long allocatedBytes;
+  };
+
+  // Source of heap memory for limb buffers. Without a resource LimbVector
+  // uses new[] / delete[]. While a resource is installed (see
+  // ScopedLimbResource), every LimbVector that outgrows its inline limbs on
+  // the same thread takes its heap buffer from it; later buffers of that
+  // vector come from the same resource, and each buffer goes back to the
+  // resource it came from.
+class LimbResource {
+public:
+  virtual ~LimbResource() {}
+  virtual unsigned *allocate(int) = 0;
+  virtual void deallocate(unsigned *, int) = 0;
+};
+  LimbResource *getLimbResource();
+  LimbResource *setLimbResource(LimbResource *);
+
+  // Bump allocator for scoped computations: allocating is a pointer bump in
+  // the current chunk, deallocating only reclaims the most recent buffer,
+  // and release() frees every chunk at once. Values whose buffers live in
+  // the arena must not outlive it; copy results out before releasing.
+class LimbArena : public LimbResource {
+  std::vector<unsigned *> chunks;
+  int chunkLimbs;
+  int capacity;
+  unsigned *top;
+  int left;
+public:
+  explicit LimbArena(int = 1 << 16);
+  ~LimbArena();
+  unsigned *allocate(int);
+  void deallocate(unsigned *, int);
+  void release();
+  // Makes every limb free again without returning memory to the heap, so
+  // a repeated computation of bounded size stops allocating after one round.
+  void rewind();
+};
+
+#ifdef INT2048_MMAP
+  // Keeps every buffer of at least minLimbs limbs in its own memory-mapped
+  // file in directory (created and unlinked at once, so nothing is left
+  // behind) and smaller ones on the heap. With it installed, values and the
+  // temporaries of operations on them can outgrow RAM and are paged to disk
+  // by the OS; the blockwise products of huge values sweep their buffers
+  // sequentially, so they slow down to disk bandwidth rather than failing.
+  // Throws std::system_error when a file cannot be created, sized or
+  // mapped. Only the installing thread uses it (worker threads allocate from
+  // the heap), and values allocated from it must not outlive it.
+class MappedLimbResource : public LimbResource {
+  std::string directory;
+  int minLimbs;
+  long long mapped;
+  long long peak;
+public:
+  explicit MappedLimbResource(const std::string & = "/tmp", int = 1 << 18);
+  unsigned *allocate(int);
+  void deallocate(unsigned *, int);
+  // bytes currently mapped, and the most ever mapped at once
+  long long mappedBytes() const { return mapped; }
+  long long peakMappedBytes() const { return peak; }
+};
+#endif
+
+  // Installs a resource for the current thread until the end of the scope.
+class ScopedLimbResource {
+  LimbResource *previous;
+public:
+  explicit ScopedLimbResource(LimbResource *);
+  ScopedLimbResource(const ScopedLimbResource &) = delete;
+  ScopedLimbResource &operator=(const ScopedLimbResource &) = delete;
+  ~ScopedLimbResource();
+};
+
+  // Limb storage for int2048. Up to SMALL_LIMBS limbs live inside the object
+  // (sharing space with the heap buffer and the resource it came from) and
+  // only larger values spill to the heap, so values up to 128 bits never
+  // allocate, and an int2048 stays at 32 bytes (int2048.cpp asserts it).
+  // Offers the subset of the std::vector interface int2048 uses.
+  static const int SMALL_LIMBS = 4;
+class LimbVector {
+  struct HeapBuffer {
+    unsigned *limbs;
+    LimbResource *resource;
+  };
+  int count;
+  int cap;
+  union {
+    HeapBuffer heap;
+    unsigned local[SMALL_LIMBS];
+  };
+  void grow(int);
+  void take(LimbVector &) noexcept;
+  // A vector over n limbs it does not own (copied inline when they fit), for
+  // int2048_view; it never frees them and must never be modified.
+  static LimbVector borrow(const unsigned *, int);
+  friend class int2048_view;
+public:
+  LimbVector();
+  explicit LimbVector(int, unsigned = 0);
+  LimbVector(const LimbVector &);
+  LimbVector(LimbVector &&) noexcept;
+  ~LimbVector();
+  LimbVector &operator=(const LimbVector &);
+  LimbVector &operator=(LimbVector &&) noexcept;
+  void swap(LimbVector &) noexcept;
+
+  int size() const { return count; }
+  bool empty() const { return count == 0; }
+  int capacity() const { return cap; }
+  unsigned *data() { return cap > SMALL_LIMBS ? heap.limbs : local; }
+  const unsigned *data() const { return cap > SMALL_LIMBS ? heap.limbs : local; }
+  unsigned *begin() { return data(); }
+  unsigned *end() { return data() + count; }
+  const unsigned *begin() const { return data(); }
+  const unsigned *end() const { return data() + count; }
+  unsigned &operator[](int i) { return data()[i]; }
+  unsigned operator[](int i) const { return data()[i]; }
+  unsigned &back() { return data()[count - 1]; }
+  unsigned back() const { return data()[count - 1]; }
+
+  void reserve(int);
+  void resize(int, unsigned = 0);
+  void assign(int, unsigned);
+  void push_back(unsigned);
+  void pop_back() { count--; }
+  void insert(unsigned *, int, unsigned);
+  void erase(unsigned *, unsigned *);
+};
+
+class int2048_view;
+
+  // Binary encoding of an int2048, little-endian throughout:
+  //   bytes 0-3   magic "I2KB"
+  //   bytes 4-5   format version (SERIAL_VERSION)
+  //   byte  6     1 for negative values, 0 otherwise
+  //   byte  7     zero
+  //   bytes 8-15  limb count n
+  //   then n 32-bit limbs, least significant first, the top one nonzero.
+  // The limbs start 16 bytes in, so they stay 4-byte aligned wherever the
+  // encoding itself is.
+  static const int SERIAL_VERSION = 1;
+  static const int SERIAL_HEADER_BYTES = 16;
+
 class int2048 {
   // todo
-  std::vector<int> digits;
+  LimbVector digits;
   bool signal; // true for positive, false for negative
 public:
   // 构造函数
@@ -29,7 +296,9 @@ public:
   int2048(long long);
   int2048(const std::string &);
   int2048(const int2048 &);
-  int2048(const std::vector<int>&, bool);
+  int2048(int2048 &&) noexcept;
+  int2048(const std::vector<unsigned>&, bool);
+  int2048(const LimbVector &, bool);
 
   // 以下给定函数的形式参数类型仅供参考，可自行选择使用常量引用或者不使用引用
   // 如果需要，可以自行增加其他所需的函数
@@ -40,12 +309,24 @@ public:
   int len() const;
   friend int absCmp(const int2048 &, const int2048 &);
   void cut();
+  void addSigned(const int2048 &, bool);
+  friend void absDivmodSchoolbook(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void absDivmodNewton(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void absDivmodBurnikelZiegler(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void absDivmod(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void floorDivmod(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend int2048 reciprocal(const int2048 &);
 
   // 读入一个大整数
   void read(const std::string &);
   // 输出储存的大整数，无需换行
   void print();
 
+  // Snapshot of the process-wide counters (see int2048Stats), and a reset
+  // of all of them to zero.
+  static int2048Stats stats();
+  static void resetStats();
+
   // 加上一个大整数
   int2048 &add(const int2048 &);
   // 返回两个大整数之和
@@ -64,6 +345,9 @@ public:
   int2048 operator-() const;
 
   int2048 &operator=(const int2048 &);
+  int2048 &operator=(int2048 &&) noexcept;
+  void swap(int2048 &) noexcept;
+  friend void swap(int2048 &, int2048 &) noexcept;
 
   int2048 &operator+=(const int2048 &);
   friend int2048 operator+(const int2048 &, const int2048 &);
@@ -72,7 +356,50 @@ public:
   friend int2048 operator-(const int2048 &, const int2048 &);
 
   int2048 &operator*=(const int2048 &);
-  friend int2048 operator*(int2048, const int2048 &);
+  friend int2048 operator*(const int2048 &, const int2048 &);
+  friend int2048 multiply(const int2048 &, const int2048 &);
+  friend void mulAccumulate(int2048 &, const int2048 &, const int2048 &, bool);
+  friend void mulAccumulate(int2048 &, const int2048 &, long long, bool);
+
+  // acc += x * y and acc -= x * y, written straight into acc's limbs
+  friend void addmul(int2048 &, const int2048 &, const int2048 &);
+  friend void submul(int2048 &, const int2048 &, const int2048 &);
+  friend void addmul(int2048 &, const int2048 &, long long);
+  friend void submul(int2048 &, const int2048 &, long long);
+  // q = a / b and r = a % b (floor semantics, as operator/ and operator%)
+  // from a single division
+  friend void divmod(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void divmod(const int2048 &, long long, int2048 &, long long &);
+
+  friend int bitLength(const int2048 &);
+  friend bool testBit(const int2048 &, int);
+
+  // a^e for e >= 0
+  friend int2048 pow(const int2048 &, long long);
+  // a^e mod m for e >= 0, with the sign convention of operator%; odd moduli
+  // go through MontgomeryContext
+  friend int2048 powmod(const int2048 &, const int2048 &, const int2048 &);
+  friend class MontgomeryContext;
+
+  // gcd and lcm are nonnegative; xgcd returns g = gcd(a, b) and sets s, t
+  // with a s + b t = g; modinv follows the sign convention of operator% and
+  // throws std::domain_error when a is not invertible modulo m
+  friend int2048 gcd(const int2048 &, const int2048 &);
+  friend int2048 lcm(const int2048 &, const int2048 &);
+  friend int2048 xgcd(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend int2048 modinv(const int2048 &, const int2048 &);
+
+  // floor(sqrt(a)) and floor(a^(1/k)) for a >= 0, with odd k also taking
+  // a < 0 (rounding toward zero); std::domain_error otherwise
+  friend int2048 isqrt(const int2048 &);
+  friend int2048 iroot(const int2048 &, unsigned);
+  friend bool isPerfectSquare(const int2048 &);
+  friend int2048 mulSchoolbook(const int2048 &, const int2048 &);
+  friend int2048 mulKaratsuba(const int2048 &, const int2048 &);
+  friend int2048 mulNtt(const int2048 &, const int2048 &);
+  // blockwise NTT product in blocks of at most the given number of limbs
+  // (a power of two; operator* passes STREAM_BLOCK)
+  friend int2048 mulStreaming(const int2048 &, const int2048 &, int);
 
   int2048 &operator/=(const int2048 &);
   friend int2048 operator/(int2048, const int2048 &);
@@ -80,8 +407,29 @@ public:
   int2048 &operator%=(const int2048 &);
   friend int2048 operator%(int2048, const int2048 &);
 
+  // scalar forms: one pass over the limbs, no temporary int2048
+  int2048 &operator*=(long long);
+  int2048 &operator/=(long long);
+  int2048 &operator%=(long long);
+  friend int2048 operator*(int2048, long long);
+  friend int2048 operator*(long long, int2048);
+  friend int2048 operator/(int2048, long long);
+  friend int2048 operator%(int2048, long long);
+
+  friend void writeDecimal(const int2048 &, char *, char *);
   friend std::istream &operator>>(std::istream &, int2048 &);
+  // serialize writes serializedSize(x) bytes; deserialize throws
+  // std::invalid_argument on anything but a well-formed encoding of a
+  // supported version, and ignores bytes after the encoded value
+  friend std::size_t serializedSize(const int2048 &);
+  friend void serialize(const int2048 &, char *);
+  friend std::string serialize(const int2048 &);
+  friend int2048 deserialize(const char *, std::size_t);
+  friend int2048 deserialize(const std::string &);
+  friend class int2048_view;
   friend std::ostream &operator<<(std::ostream &, const int2048 &);
+  friend int2048 operator<<(int2048, int);
+  friend int2048 operator>>(int2048, int);
 
   friend bool operator==(const int2048 &, const int2048 &);
   friend bool operator!=(const int2048 &, const int2048 &);
@@ -90,425 +438,4225 @@ public:
   friend bool operator<=(const int2048 &, const int2048 &);
   friend bool operator>=(const int2048 &, const int2048 &);
 };
+
+// Montgomery arithmetic modulo a fixed odd modulus m > 1, with R = 2^(32n)
+// for an n-limb m. All reduction constants are computed once in the
+// constructor; afterwards mul() and pow() never divide.
+class MontgomeryContext {
+  int2048 modulus;
+  int n;
+  unsigned mInv;     // -m^-1 mod 2^32
+  int2048 mInvFull;  // -m^-1 mod R
+  int2048 r2;        // R^2 mod m
+  int2048 one;       // R mod m
+public:
+  explicit MontgomeryContext(const int2048 &);
+  // x R^-1 mod m, for 0 <= x < m R
+  int2048 reduce(const int2048 &) const;
+  // x R mod m for any x, and back
+  int2048 toMont(const int2048 &) const;
+  int2048 fromMont(const int2048 &) const;
+  // a b R^-1 mod m, for a and b in Montgomery form
+  int2048 mul(const int2048 &, const int2048 &) const;
+  // a^e mod m for an ordinary (not Montgomery form) a and e >= 0
+  int2048 pow(const int2048 &, const int2048 &) const;
+};
+
+// A read-only int2048 over limbs that belong to someone else, such as a
+// serialized value in an mmap'd file. It converts to const int2048 &, so it
+// compares with and is an operand of every int2048 operator and function
+// without its limbs being copied (except by operators that take an operand
+// by value, as for any int2048). The limbs must not change or go away
+// while the view, or an expression using it, is alive.
+class int2048_view {
+  int2048 value;
+  const unsigned *source; // the borrowed limbs, null if value owns a copy
+  void borrow(const unsigned *, int, bool);
+public:
+  // n little-endian limbs with the given sign (true for nonnegative); high
+  // zero limbs are ignored
+  int2048_view(const unsigned *, int, bool = true);
+  // A serialized value (see SERIAL_VERSION). The limbs are borrowed when the
+  // host is little-endian and they are 4-byte aligned, and copied otherwise.
+  int2048_view(const char *, std::size_t);
+  // Borrows the same limbs again.
+  int2048_view(const int2048_view &);
+  int2048_view &operator=(const int2048_view &) = delete;
+
+  operator const int2048 &() const { return value; }
+  const int2048 &get() const { return value; }
+  bool borrowed() const { return source != nullptr; }
+};
+
+// n! for n >= 0, and the binomial coefficient C(n, k): zero for k < 0 or
+// k > n >= 0 and (-1)^k C(k - n - 1, k) for n < 0. Both multiply their
+// factors in balanced trees.
+int2048 factorial(long long);
+int2048 binomial(long long, long long);
+// out[i] = a[i] + b[i], out[i] = a[i] * b[i] and (q[i], r[i]) = divmod(a[i],
+// b[i]) for i < n, spread over getThreadCount() threads in dynamically
+// claimed chunks. Every thread runs its operations inside one LimbArena of
+// its own that is rewound after each operation, so once warm the only
+// allocations are outputs growing past their capacity. An output may alias
+// the inputs of its own index. An output that grows takes its buffer from
+// the resource of its current heap buffer, or else from the one installed on
+// the calling thread, which must be usable from any thread (the default
+// heap is). The first exception thrown by an operation is rethrown.
+void batchAdd(const int2048 *, const int2048 *, int2048 *, int);
+void batchMul(const int2048 *, const int2048 *, int2048 *, int);
+void batchDivmod(const int2048 *, const int2048 *, int2048 *, int2048 *, int);
+// The product of all values in a range, multiplied pairwise in a balanced
+// tree so that the large multiplications are between equal-sized operands.
+int2048 product(std::vector<int2048>);
+std::size_t serializedSize(const int2048 &);
+void serialize(const int2048 &, char *);
+std::string serialize(const int2048 &);
+int2048 deserialize(const char *, std::size_t);
+int2048 deserialize(const std::string &);
+template <class Iterator>
+int2048 product(Iterator begin, Iterator end) {
+  return product(std::vector<int2048>(begin, end));
+}
+
+// Namespace-scope declarations of the int2048 friends, so that they are
+// also found (through the implicit conversion) for int2048_view operands.
+int2048 operator+(const int2048 &, const int2048 &);
+int2048 operator-(const int2048 &, const int2048 &);
+int2048 operator*(const int2048 &, const int2048 &);
+int2048 operator/(int2048, const int2048 &);
+int2048 operator%(int2048, const int2048 &);
+int2048 operator*(int2048, long long);
+int2048 operator*(long long, int2048);
+int2048 operator/(int2048, long long);
+int2048 operator%(int2048, long long);
+std::ostream &operator<<(std::ostream &, const int2048 &);
+int2048 operator<<(int2048, int);
+int2048 operator>>(int2048, int);
+bool operator==(const int2048 &, const int2048 &);
+bool operator!=(const int2048 &, const int2048 &);
+bool operator<(const int2048 &, const int2048 &);
+bool operator>(const int2048 &, const int2048 &);
+bool operator<=(const int2048 &, const int2048 &);
+bool operator>=(const int2048 &, const int2048 &);
 } // namespace sjtu
+
+
+
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#ifdef INT2048_THREADS
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#endif
+#ifdef INT2048_STATS
+#include <atomic>
+#include <chrono>
+#endif
+#if defined(INT2048_SIMD) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define INT2048_X86_KERNELS
+#include <immintrin.h>
+#endif
+#ifdef INT2048_MMAP
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace sjtu {
 
-int2048::int2048() {
-    signal = true;
+// Limbs are 32-bit binary words; a limb product plus two limbs always fits
+// in an unsigned long long.
+static const unsigned long long LIMB_BASE = 1ull << 32;
+
+// Limb counts are ints, so no value has more than INT_MAX limbs. Operations
+// that can produce a longer value check its length here first and throw
+// std::length_error instead of wrapping around.
+static int checkedLimbs(long long n) {
+    if (n > INT_MAX) {
+        throw std::length_error("int2048: value longer than INT_MAX limbs");
+    }
+    return (int)n;
 }
 
-int2048::int2048(long long num) {
-    digits.resize(6);
-    if (num < 0) {
-        signal = false;
-        num = -num;
-    } else {
-        signal = true;
+// Guards state that threads share (the decimal power cache, the first error
+// of a batch). Without INT2048_THREADS there is only ever one thread, and
+// locking does nothing.
+#ifdef INT2048_THREADS
+typedef std::mutex Mutex;
+#else
+struct Mutex {
+    void lock() {}
+    void unlock() {}
+};
+#endif
+
+class MutexLock {
+    Mutex &mutex;
+public:
+    explicit MutexLock(Mutex &mutex) : mutex(mutex) {
+        mutex.lock();
     }
-    for (int i = 0; i < 6; i++) {
-        digits[i] = num % 10000;
-        num /= 10000;
+
+    ~MutexLock() {
+        mutex.unlock();
     }
-    cut();
+};
+
+// ===================================
+// Instrumentation
+// ===================================
+
+static const char *const STAT_NAMES[STAT_KINDS] = {
+    "add", "sub", "mul", "div", "read", "write",
+    "mul_schoolbook", "mul_karatsuba", "mul_ntt", "mul_streaming",
+    "div_schoolbook", "div_burnikel_ziegler", "div_newton"
+};
+
+const char *statName(StatKind kind) {
+    return STAT_NAMES[kind];
 }
 
-int2048::int2048(const std::string & num) {
-    read(num);
+// With INT2048_STATS defined, STAT_SCOPE(kind, n) counts a call of kind on n
+// limbs and times it until the end of the enclosing block, STAT_LIMBS adds
+// limbs to a kind after the fact and STAT_ALLOC counts a limb buffer of n
+// limbs. Without it
+// all three expand to nothing and their arguments are never evaluated.
+#ifdef INT2048_STATS
+
+struct AtomicStatCounter {
+    std::atomic<long long> calls;
+    std::atomic<long long> limbs;
+    std::atomic<long long> cycles;
+};
+
+static AtomicStatCounter statCounters[STAT_KINDS];
+static std::atomic<long long> statAllocations;
+static std::atomic<long long> statAllocatedBytes;
+// Open scopes of each kind on this thread; only the outermost is timed.
+static thread_local int statDepth[STAT_KINDS];
+
+static long long statClock() {
+#ifdef INT2048_X86_KERNELS
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
 }
 
-int2048::int2048(const std::vector<int> &digits, bool signal=true) {
-    this->digits = digits;
-    this->signal = signal;
+static void statAdd(std::atomic<long long> &counter, long long n) {
+    counter.fetch_add(n, std::memory_order_relaxed);
 }
 
-void int2048::read(const std::string & num) {
-    if (num[0] == '-') {
-        signal = false;
-    } else {
-        signal = true;
+class StatScope {
+    StatKind kind;
+    long long start;
+public:
+    StatScope(StatKind kind, long long limbs) : kind(kind), start(0) {
+        statAdd(statCounters[kind].calls, 1);
+        statAdd(statCounters[kind].limbs, limbs);
+        if (statDepth[kind]++ == 0) {
+            start = statClock();
+        }
     }
-    int p = num.size() - 1;
-    digits.clear();
-    digits.resize((num.size() / 4) + 1);
-    for (int i = 0; i < (num.size() / 4) + 1; i++) {
-        digits[i] = 0;
-        for (int j = 0; j < DIGIT_NUM; j++, p--) {
-            if (p < 0 || (p == 0 && num[p] == '-')) {
-                return;
-            }
-            digits[i] += (num[p] - '0') * pow(10, j);
+
+    ~StatScope() {
+        if (--statDepth[kind] == 0) {
+            statAdd(statCounters[kind].cycles, statClock() - start);
         }
     }
-    if (digits.size()==1||digits[0]==0) {
-        signal = true;
+};
+
+#define STAT_SCOPE(kind, n) StatScope statScope(kind, n)
+#define STAT_LIMBS(kind, n) statAdd(statCounters[kind].limbs, n)
+#define STAT_ALLOC(n) (statAdd(statAllocations, 1), statAdd(statAllocatedBytes, (long long)(n) * sizeof(unsigned)))
+
+#else
+
+#define STAT_SCOPE(kind, n) ((void)0)
+#define STAT_LIMBS(kind, n) ((void)0)
+#define STAT_ALLOC(n) ((void)0)
+
+#endif
+
+int2048Stats int2048::stats() {
+    int2048Stats s = {};
+#ifdef INT2048_STATS
+    s.enabled = true;
+    for (int i = 0; i < STAT_KINDS; i++) {
+        s.counters[i].calls = statCounters[i].calls.load(std::memory_order_relaxed);
+        s.counters[i].limbs = statCounters[i].limbs.load(std::memory_order_relaxed);
+        s.counters[i].cycles = statCounters[i].cycles.load(std::memory_order_relaxed);
     }
-    cut();
+    s.allocations = statAllocations.load(std::memory_order_relaxed);
+    s.allocatedBytes = statAllocatedBytes.load(std::memory_order_relaxed);
+#endif
+    return s;
 }
 
-int2048::int2048(const int2048 & num) {
-    digits = num.digits;
-    signal = num.signal;
+void int2048::resetStats() {
+#ifdef INT2048_STATS
+    for (int i = 0; i < STAT_KINDS; i++) {
+        statCounters[i].calls = 0;
+        statCounters[i].limbs = 0;
+        statCounters[i].cycles = 0;
+    }
+    statAllocations = 0;
+    statAllocatedBytes = 0;
+#endif
 }
 
-void int2048::print() {
-    std::cout << *this;
+// ===================================
+// Limb storage
+// ===================================
+
+static thread_local LimbResource *limbResource = nullptr;
+
+LimbResource *getLimbResource() {
+    return limbResource;
 }
 
-void int2048::cut() {
-    for (int i = digits.size()-1; i >= 0; i--) {
-        if (digits[i] != 0) {
-            digits.resize(i+1);
-            return;
-        }
-    }
-    digits.resize(1);
-    signal = true;
+// Returns the previously installed resource.
+LimbResource *setLimbResource(LimbResource *resource) {
+    std::swap(resource, limbResource);
+    return resource;
 }
 
-int2048 int2048::operator+() const {
-    return int2048(*this);
+ScopedLimbResource::ScopedLimbResource(LimbResource *resource) {
+    previous = setLimbResource(resource);
 }
 
-int2048 int2048::operator-() const {
-    return int2048(this->digits, !this->signal);
+ScopedLimbResource::~ScopedLimbResource() {
+    setLimbResource(previous);
 }
 
-int int2048::len() const {
-  for (int i = digits.size()-1; i>=0; i--) {
-    if (digits[i]!=0) {
-      if (digits[i] > 999) {
-        return DIGIT_NUM * i + 4;
-      }
-      else if (digits[i] > 99) {
-        return DIGIT_NUM * i + 3;
-      }
-      else if (digits[i] > 9) {
-        return DIGIT_NUM * i + 2;
-      }
-      else {
-        return DIGIT_NUM * i + 1;
-      }
-    }
-  }
-  return 0;
+LimbArena::LimbArena(int chunkLimbs) {
+    this->chunkLimbs = chunkLimbs;
+    capacity = 0;
+    top = nullptr;
+    left = 0;
 }
 
-bool operator<(const int2048 &a, const int2048 &b) {
-    if (!a.signal&&b.signal) {
-        return true;
+LimbArena::~LimbArena() {
+    release();
+}
+
+unsigned *LimbArena::allocate(int n) {
+    if (n > left) {
+        int size = std::max(n, chunkLimbs);
+        chunks.push_back(new unsigned[size]);
+        capacity += size;
+        top = chunks.back();
+        left = size;
     }
-    else if (a.signal&&!b.signal) {
-        return false;
+    unsigned *p = top;
+    top += n;
+    left -= n;
+    return p;
+}
+
+void LimbArena::deallocate(unsigned *p, int n) {
+    if (p + n == top) {
+        top = p;
+        left += n;
     }
-    else {
-        int cmp = absCmp(a, b);
-        if (cmp < 0) {
-            return a.signal;
-        }
-        else if (cmp > 0) {
-            return !a.signal;
-        }
-        else {
-            return false;
-        }
+}
+
+void LimbArena::release() {
+    for (std::size_t i = 0; i < chunks.size(); i++) {
+        delete[] chunks[i];
     }
+    chunks.clear();
+    capacity = 0;
+    top = nullptr;
+    left = 0;
 }
 
-bool operator>(const int2048 &a, const int2048 &b) {
-    if (!a.signal&&b.signal) {
-        return false;
+// Several chunks are merged into one of their total size first, which then
+// holds everything the last round needed.
+void LimbArena::rewind() {
+    if (chunks.size() > 1) {
+        int total = capacity;
+        release();
+        chunks.push_back(new unsigned[total]);
+        capacity = total;
     }
-    else if (a.signal&&!b.signal) {
-        return true;
+    if (!chunks.empty()) {
+        top = chunks[0];
+        left = capacity;
     }
-    else {
-        int cmp = absCmp(a, b);
-        if (cmp < 0) {
-            return !a.signal;
+}
+
+#ifdef INT2048_MMAP
+MappedLimbResource::MappedLimbResource(const std::string &directory, int minLimbs) {
+    this->directory = directory;
+    this->minLimbs = minLimbs;
+    mapped = 0;
+    peak = 0;
+}
+
+unsigned *MappedLimbResource::allocate(int n) {
+    if (n >= minLimbs) {
+        std::string path = directory + "/int2048-XXXXXX";
+        int fd = mkstemp(&path[0]);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "int2048: cannot create " + path);
         }
-        else if (cmp > 0) {
-            return a.signal;
+        unlink(path.c_str());
+        size_t bytes = (size_t)n * sizeof(unsigned);
+#ifdef __linux__
+        // reserving the blocks up front makes a full disk fail here rather
+        // than raise SIGBUS on first touch of the mapping
+        int error = posix_fallocate(fd, 0, bytes);
+#else
+        int error = ftruncate(fd, bytes) == 0 ? 0 : errno;
+#endif
+        void *p = MAP_FAILED;
+        if (error == 0) {
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            error = errno;
         }
-        else {
-            return false;
+        close(fd);
+        if (p == MAP_FAILED) {
+            throw std::system_error(error, std::generic_category(), "int2048: cannot map " + path);
         }
+        mapped += bytes;
+        peak = std::max(peak, mapped);
+        return (unsigned *)p;
     }
+    return new unsigned[n];
 }
 
-int absCmp(const int2048 &a, const int2048 &b) {
-    int la = a.len();
-    int lb = b.len();
-    if (la > lb) {
-        return 1;
+// Buffers are told apart by size, since each is returned with the size it
+// was allocated with.
+void MappedLimbResource::deallocate(unsigned *p, int n) {
+    if (n >= minLimbs) {
+        munmap(p, (size_t)n * sizeof(unsigned));
+        mapped -= (long long)n * sizeof(unsigned);
+        return;
     }
-    else if (la < lb) {
-        return -1;
+    delete[] p;
+}
+#endif
+
+static unsigned *allocLimbs(LimbResource *resource, int n) {
+    STAT_ALLOC(n);
+    return resource ? resource->allocate(n) : new unsigned[n];
+}
+
+static void freeLimbs(LimbResource *resource, unsigned *p, int n) {
+    if (resource) {
+        resource->deallocate(p, n);
     }
-    for (int i = (la - 1) / 4; i >= 0; i--) {
-        if (a.digits[i] > b.digits[i]) {
-            return 1;
-        }
-        else if (a.digits[i] < b.digits[i]) {
-            return -1;
-        }
+    else {
+        delete[] p;
     }
-    return 0;
 }
 
-bool operator!=(const int2048 &a, const int2048 &b) {
-    return !(a==b);
+// Two limb counts and a heap buffer with its resource, or the inline limbs,
+// plus the sign: the same 32 bytes as the std::vector<int> and sign that
+// int2048 used to hold.
+static_assert(sizeof(int2048) <= 32, "int2048 should fit in 32 bytes");
+
+LimbVector::LimbVector() {
+    count = 0;
+    cap = SMALL_LIMBS;
 }
 
-bool operator==(const int2048 &a, const int2048 &b) {
-    if (a.digits.size()==1&&a.digits[0]==0&&b.digits.size()==1&&b.digits[0]==0) {
-        return true;
-    }
-    return (a.signal == b.signal) && (absCmp(a, b) == 0);
+LimbVector::LimbVector(int n, unsigned v) {
+    count = 0;
+    cap = SMALL_LIMBS;
+    assign(n, v);
 }
 
-bool operator>=(int2048 &a, int2048 &b) {
-    return !(a < b);
+LimbVector::LimbVector(const LimbVector &a) {
+    count = 0;
+    cap = SMALL_LIMBS;
+    *this = a;
 }
 
-bool operator<=(int2048 &a, int2048 &b) {
-    return !(a > b);
+LimbVector::LimbVector(LimbVector &&a) noexcept {
+    cap = SMALL_LIMBS;
+    take(a);
 }
 
-int2048 & int2048::operator=(const int2048 &a) {
-    digits = a.digits;
-    signal = a.signal;
+LimbVector::~LimbVector() {
+    if (cap > SMALL_LIMBS) {
+        freeLimbs(heap.resource, heap.limbs, cap);
+    }
+}
+
+LimbVector &LimbVector::operator=(const LimbVector &a) {
+    if (this != &a) {
+        reserve(a.count);
+        std::copy(a.begin(), a.end(), data());
+        count = a.count;
+    }
     return *this;
 }
 
-int2048 operator+(const int2048 &a, const int2048 &b) {
-    if (a.signal != b.signal) {
-        int2048 d;
-        int2048 res;
-        int cmp = absCmp(a, b);
-        if (cmp < 0) {
-            res = b;
-            d = a;
-        }
-        else if (cmp > 0) {
-            res = a;
-            d = b;
-        }
-        else {
-            return int2048(0);
-        }
-        res.cut();
-        d.cut();
-        int borrow = 0;
-        for (int i = 0; i < res.digits.size(); i++) {
-            if (i >= d.digits.size()) {
-                if (!borrow) {
-                    break;
-                }
-                res.digits[i] -= borrow;
-            }
-            else {
-                res.digits[i] -= d.digits[i] + borrow;
-            }
-            if (res.digits[i] < 0) {
-                res.digits[i] += 10000;
-                borrow = 1;
-            }
-            else {
-                borrow = 0;
-            }
+LimbVector &LimbVector::operator=(LimbVector &&a) noexcept {
+    if (this != &a) {
+        if (cap > SMALL_LIMBS) {
+            freeLimbs(heap.resource, heap.limbs, cap);
+            cap = SMALL_LIMBS;
         }
-        return res;
+        take(a);
+    }
+    return *this;
+}
+
+// Steals a's heap buffer, together with the resource it came from, or
+// copies its inline limbs; either way a is left empty. *this must not own
+// a heap buffer.
+void LimbVector::take(LimbVector &a) noexcept {
+    count = a.count;
+    if (a.cap > SMALL_LIMBS) {
+        heap = a.heap;
+        cap = a.cap;
+        a.cap = SMALL_LIMBS;
     }
     else {
-        int2048 res;
-        res = a;
-        int carry = 0;
-        res.digits.resize(std::max(a.digits.size(), b.digits.size()));
-        for (int i = 0; i < res.digits.size(); i++) {
-            if (i < b.digits.size()) {
-                res.digits[i] += b.digits[i];
-            }
-            if (i >= b.digits.size() && carry == 0) {
-                break;
-            }
-            res.digits[i] += carry;
-            if (res.digits[i] >= 10000) {
-                res.digits[i] -= 10000;
-                carry = 1;
-            }
-            else {
-                carry = 0;
-            }
-        }
-        if (carry) {
-            res.digits.push_back(1);
-        }
-        res.cut();
-        return res;
+        std::copy(a.local, a.local + a.count, local);
     }
+    a.count = 0;
 }
 
-int2048 operator-(const int2048 &a, const int2048 &b) {
-    int2048 bn = -b;
-    return a + bn;
+void LimbVector::swap(LimbVector &a) noexcept {
+    LimbVector t(std::move(a));
+    a = std::move(*this);
+    *this = std::move(t);
 }
 
-int2048 & int2048::operator+=(const int2048 & a) {
-    *this = (*this) + a;
-    return *this;
+// Moves to a heap buffer of at least n limbs, growing geometrically so
+// that push_back stays amortized O(1). The first heap buffer comes from the
+// thread's current resource, later ones from the resource of the buffer
+// they replace.
+void LimbVector::grow(int n) {
+    int newCap = std::max(n, 2 * cap);
+    LimbResource *resource = cap > SMALL_LIMBS ? heap.resource : limbResource;
+    unsigned *p = allocLimbs(resource, newCap);
+    std::copy(begin(), end(), p);
+    if (cap > SMALL_LIMBS) {
+        freeLimbs(resource, heap.limbs, cap);
+    }
+    heap.limbs = p;
+    heap.resource = resource;
+    cap = newCap;
 }
 
-int2048 & int2048::operator-=(const int2048 & a) {
-    *this = (*this) - a;
-    return *this;
+void LimbVector::reserve(int n) {
+    if (n > cap) {
+        grow(n);
+    }
 }
 
-int2048 &int2048::add(const int2048 & a) {
-    return (*this) += a;
+void LimbVector::resize(int n, unsigned v) {
+    reserve(n);
+    if (n > count) {
+        std::fill(data() + count, data() + n, v);
+    }
+    count = n;
 }
 
-int2048 add(int2048 a, const int2048 & b) {
-    return a + b;
+void LimbVector::assign(int n, unsigned v) {
+    reserve(n);
+    std::fill(data(), data() + n, v);
+    count = n;
 }
 
-int2048 minus(int2048 a, const int2048 & b) {
-    return a - b;
+void LimbVector::push_back(unsigned v) {
+    reserve(count + 1);
+    data()[count++] = v;
 }
 
-int2048 & int2048::minus(const int2048 & a) {
-    return (*this) -= a;
+void LimbVector::insert(unsigned *pos, int n, unsigned v) {
+    int at = pos - data();
+    reserve(count + n);
+    unsigned *p = data();
+    std::copy_backward(p + at, p + count, p + count + n);
+    std::fill(p + at, p + at + n, v);
+    count += n;
 }
 
-int2048 & int2048::operator*=(const int2048 & a) {
-    *this = (*this) * a;
-    return *this;
+void LimbVector::erase(unsigned *first, unsigned *last) {
+    std::copy(last, end(), first);
+    count -= last - first;
 }
 
-std::istream &operator>>(std::istream &is, int2048 &s) {
-    std::string str;
-    is >> str;
-    s.read(str);
-    return is;
+// Owner of every borrowed buffer: it never frees one, and nothing may grow
+// into one since vectors over borrowed limbs are never modified.
+class BorrowedLimbs : public LimbResource {
+public:
+    unsigned *allocate(int) {
+        throw std::logic_error("int2048: borrowed limbs are read-only");
+    }
+
+    void deallocate(unsigned *, int) {
+    }
+};
+
+static BorrowedLimbs borrowedLimbs;
+
+LimbVector LimbVector::borrow(const unsigned *p, int n) {
+    LimbVector v;
+    if (n <= SMALL_LIMBS) {
+        std::copy(p, p + n, v.local);
+    }
+    else {
+        v.heap.limbs = const_cast<unsigned *>(p);
+        v.heap.resource = &borrowedLimbs;
+        v.cap = n;
+    }
+    v.count = n;
+    return v;
+}
+
+int2048::int2048() {
+    digits.assign(1, 0);
+    signal = true;
+}
+
+int2048::int2048(long long num) {
+    unsigned long long mag;
+    if (num < 0) {
+        signal = false;
+        mag = 0ull - (unsigned long long)num;
+    } else {
+        signal = true;
+        mag = num;
+    }
+    digits.resize(2);
+    digits[0] = (unsigned)mag;
+    digits[1] = (unsigned)(mag >> 32);
+    cut();
+}
+
+int2048::int2048(const std::string & num) {
+    signal = true;
+    read(num);
+}
+
+int2048::int2048(const std::vector<unsigned> &digits, bool signal=true) {
+    this->digits.resize(digits.size());
+    std::copy(digits.begin(), digits.end(), this->digits.begin());
+    this->signal = signal;
+}
+
+int2048::int2048(const LimbVector &digits, bool signal=true) {
+    this->digits = digits;
+    this->signal = signal;
+}
+
+int2048::int2048(const int2048 & num) {
+    digits = num.digits;
+    signal = num.signal;
+}
+
+// The moved-from value keeps no limbs; it may only be assigned to or
+// destroyed.
+int2048::int2048(int2048 && num) noexcept : digits(std::move(num.digits)), signal(num.signal) {
+}
+
+// ===================================
+// Limb kernels
+// ===================================
+
+// Addition, subtraction, comparison and multiplication by one limb over
+// equal-length limb arrays. Each has a scalar, an SSE4.1 and an AVX2
+// version; the vector ones add all lanes at once and then resolve the
+// carries (or borrows) of a whole vector from two lane masks, the lanes
+// that overflow and the lanes that pass an incoming carry on, instead of
+// branching limb by limb. Arrays shorter than SIMD_MIN_LIMBS always take
+// the scalar loops.
+static const int SIMD_MIN_LIMBS = 16;
+
+static unsigned addLoop(unsigned *r, const unsigned *a, const unsigned *b, int n, unsigned carry) {
+    unsigned long long t = carry;
+    for (int i = 0; i < n; i++) {
+        t += (unsigned long long)a[i] + b[i];
+        r[i] = (unsigned)t;
+        t >>= 32;
+    }
+    return t;
+}
+
+static unsigned subLoop(unsigned *r, const unsigned *a, const unsigned *b, int n, unsigned borrow) {
+    for (int i = 0; i < n; i++) {
+        unsigned long long t = (unsigned long long)a[i] - b[i] - borrow;
+        r[i] = (unsigned)t;
+        borrow = (t >> 32) & 1;
+    }
+    return borrow;
+}
+
+static int cmpLoop(const unsigned *a, const unsigned *b, int n) {
+    for (int i = n - 1; i >= 0; i--) {
+        if (a[i] != b[i]) {
+            return a[i] > b[i] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+static unsigned mul1Loop(unsigned *r, const unsigned *a, int n, unsigned v, unsigned carry) {
+    unsigned long long t = carry;
+    for (int i = 0; i < n; i++) {
+        t += (unsigned long long)a[i] * v;
+        r[i] = (unsigned)t;
+        t >>= 32;
+    }
+    return t;
+}
+
+#ifdef INT2048_X86_KERNELS
+
+// For lane masks g (the lane's own sum overflowed) and p (the lane is all
+// ones, so an incoming carry passes through), which are disjoint, returns
+// the mask of lanes that receive a carry and sets carry to the carry out
+// of the top lane: with X = g | p and Y = g, the bits of X + Y + carry
+// carry exactly where the limbs do. Borrows work the same way, with p the
+// lanes that are zero.
+static unsigned resolveCarries(unsigned g, unsigned p, int lanes, unsigned &carry) {
+    unsigned t = (g << 1) + p + carry;
+    carry = t >> lanes;
+    return (t ^ p) & ((1u << lanes) - 1);
+}
+
+// All ones in the lanes of in, as a mask vector.
+__attribute__((target("sse4.1")))
+static __m128i laneMaskSse(unsigned in) {
+    const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+    return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(in), bits), bits);
+}
+
+__attribute__((target("sse4.1")))
+static unsigned addNSse(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    const __m128i ones = _mm_set1_epi32(-1);
+    unsigned carry = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i s = _mm_add_epi32(x, _mm_loadu_si128((const __m128i *)(b + i)));
+        // s < x (unsigned) where the lane overflowed
+        unsigned g = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_xor_si128(x, bias), _mm_xor_si128(s, bias))));
+        unsigned p = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(s, ones)));
+        unsigned in = resolveCarries(g, p, 4, carry);
+        _mm_storeu_si128((__m128i *)(r + i), _mm_sub_epi32(s, laneMaskSse(in)));
+    }
+    return addLoop(r + i, a + i, b + i, n - i, carry);
+}
+
+__attribute__((target("sse4.1")))
+static unsigned subNSse(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    const __m128i zero = _mm_setzero_si128();
+    unsigned borrow = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i d = _mm_sub_epi32(x, y);
+        unsigned g = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_xor_si128(y, bias), _mm_xor_si128(x, bias))));
+        unsigned p = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(d, zero)));
+        unsigned in = resolveCarries(g, p, 4, borrow);
+        _mm_storeu_si128((__m128i *)(r + i), _mm_add_epi32(d, laneMaskSse(in)));
+    }
+    return subLoop(r + i, a + i, b + i, n - i, borrow);
+}
+
+__attribute__((target("sse4.1")))
+static int cmpNSse(const unsigned *a, const unsigned *b, int n) {
+    for (; n >= 4; n -= 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + n - 4));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + n - 4));
+        __m128i diff = _mm_xor_si128(x, y);
+        if (!_mm_testz_si128(diff, diff)) {
+            return cmpLoop(a + n - 4, b + n - 4, 4);
+        }
+    }
+    return cmpLoop(a, b, n);
+}
+
+// The 64-bit products of the even and the odd lanes are split into their
+// low halves, which stay in place, and their high halves, which move up one
+// lane; the two are then added like addNSse does. The high half of the top
+// lane is carried into the next block, and since a limb product's high half
+// is at most 2^32 - 2 it never overflows with the carry bit added.
+__attribute__((target("sse4.1")))
+static unsigned mul1Sse(unsigned *r, const unsigned *a, int n, unsigned v, unsigned carry) {
+    const __m128i bias = _mm_set1_epi32(INT_MIN);
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i scale = _mm_set1_epi32(v);
+    // the previous block's high halves; only the top lane is used
+    __m128i last = _mm_insert_epi32(_mm_setzero_si128(), carry, 3);
+    unsigned bit = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i even = _mm_mul_epu32(x, scale);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), scale);
+        __m128i lo = _mm_blend_epi16(even, _mm_slli_epi64(odd, 32), 0xcc);
+        __m128i hi = _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xcc);
+        __m128i s = _mm_add_epi32(lo, _mm_alignr_epi8(hi, last, 12));
+        last = hi;
+        unsigned g = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_xor_si128(lo, bias), _mm_xor_si128(s, bias))));
+        unsigned p = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(s, ones)));
+        unsigned in = resolveCarries(g, p, 4, bit);
+        _mm_storeu_si128((__m128i *)(r + i), _mm_sub_epi32(s, laneMaskSse(in)));
+    }
+    return mul1Loop(r + i, a + i, n - i, v, (unsigned)_mm_extract_epi32(last, 3) + bit);
+}
+
+__attribute__((target("avx2")))
+static __m256i laneMaskAvx(unsigned in) {
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(in), bits), bits);
+}
+
+__attribute__((target("avx2")))
+static unsigned addNAvx(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    const __m256i bias = _mm256_set1_epi32(INT_MIN);
+    const __m256i ones = _mm256_set1_epi32(-1);
+    unsigned carry = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i s = _mm256_add_epi32(x, _mm256_loadu_si256((const __m256i *)(b + i)));
+        unsigned g = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_xor_si256(x, bias), _mm256_xor_si256(s, bias))));
+        unsigned p = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(s, ones)));
+        unsigned in = resolveCarries(g, p, 8, carry);
+        _mm256_storeu_si256((__m256i *)(r + i), _mm256_sub_epi32(s, laneMaskAvx(in)));
+    }
+    return addLoop(r + i, a + i, b + i, n - i, carry);
+}
+
+__attribute__((target("avx2")))
+static unsigned subNAvx(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    const __m256i bias = _mm256_set1_epi32(INT_MIN);
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned borrow = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i d = _mm256_sub_epi32(x, y);
+        unsigned g = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_xor_si256(y, bias), _mm256_xor_si256(x, bias))));
+        unsigned p = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(d, zero)));
+        unsigned in = resolveCarries(g, p, 8, borrow);
+        _mm256_storeu_si256((__m256i *)(r + i), _mm256_add_epi32(d, laneMaskAvx(in)));
+    }
+    return subLoop(r + i, a + i, b + i, n - i, borrow);
+}
+
+__attribute__((target("avx2")))
+static int cmpNAvx(const unsigned *a, const unsigned *b, int n) {
+    for (; n >= 8; n -= 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + n - 8));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + n - 8));
+        __m256i diff = _mm256_xor_si256(x, y);
+        if (!_mm256_testz_si256(diff, diff)) {
+            return cmpLoop(a + n - 8, b + n - 8, 8);
+        }
+    }
+    return cmpLoop(a, b, n);
+}
+
+__attribute__((target("avx2")))
+static unsigned mul1Avx(unsigned *r, const unsigned *a, int n, unsigned v, unsigned carry) {
+    const __m256i bias = _mm256_set1_epi32(INT_MIN);
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i scale = _mm256_set1_epi32(v);
+    const __m256i rotate = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+    unsigned high = carry, bit = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i even = _mm256_mul_epu32(x, scale);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), scale);
+        __m256i lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+        __m256i hi = _mm256_permutevar8x32_epi32(_mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa), rotate);
+        unsigned top = _mm256_extract_epi32(hi, 0);
+        hi = _mm256_blend_epi32(hi, _mm256_set1_epi32(high), 0x01);
+        high = top;
+        __m256i s = _mm256_add_epi32(lo, hi);
+        unsigned g = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_xor_si256(lo, bias), _mm256_xor_si256(s, bias))));
+        unsigned p = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(s, ones)));
+        unsigned in = resolveCarries(g, p, 8, bit);
+        _mm256_storeu_si256((__m256i *)(r + i), _mm256_sub_epi32(s, laneMaskAvx(in)));
+    }
+    return mul1Loop(r + i, a + i, n - i, v, high + bit);
+}
+
+#endif
+
+static unsigned addNScalar(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    return addLoop(r, a, b, n, 0);
+}
+
+static unsigned subNScalar(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    return subLoop(r, a, b, n, 0);
+}
+
+struct LimbKernels {
+    unsigned (*add)(unsigned *, const unsigned *, const unsigned *, int);
+    unsigned (*sub)(unsigned *, const unsigned *, const unsigned *, int);
+    int (*cmp)(const unsigned *, const unsigned *, int);
+    unsigned (*mul1)(unsigned *, const unsigned *, int, unsigned, unsigned);
+};
+
+static const LimbKernels KERNELS[] = {
+    {addNScalar, subNScalar, cmpLoop, mul1Loop},
+#ifdef INT2048_X86_KERNELS
+    {addNSse, subNSse, cmpNSse, mul1Sse},
+    {addNAvx, subNAvx, cmpNAvx, mul1Avx},
+#endif
+};
+
+static SimdLevel supportedSimdLevel() {
+#ifdef INT2048_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SIMD_SSE41;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+// Static initialization switches to the best supported level; until then
+// (and in other translation units' initializers) the scalar loops run.
+static SimdLevel simdLevel = SIMD_SCALAR;
+static const LimbKernels *kernels = &KERNELS[SIMD_SCALAR];
+static const bool simdDetected = (setSimdLevel(SIMD_AVX2), true);
+
+void setSimdLevel(SimdLevel level) {
+    simdLevel = std::min(level, supportedSimdLevel());
+    kernels = &KERNELS[simdLevel];
+}
+
+SimdLevel getSimdLevel() {
+    return simdLevel;
+}
+
+// r[0..n) = a[0..n) + b[0..n), returning the carry out.
+static unsigned addN(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    return n < SIMD_MIN_LIMBS ? addLoop(r, a, b, n, 0) : kernels->add(r, a, b, n);
+}
+
+// r[0..n) = a[0..n) - b[0..n), returning the borrow out.
+static unsigned subN(unsigned *r, const unsigned *a, const unsigned *b, int n) {
+    return n < SIMD_MIN_LIMBS ? subLoop(r, a, b, n, 0) : kernels->sub(r, a, b, n);
+}
+
+// Sign of a[0..n) - b[0..n).
+static int cmpN(const unsigned *a, const unsigned *b, int n) {
+    return n < SIMD_MIN_LIMBS ? cmpLoop(a, b, n) : kernels->cmp(a, b, n);
+}
+
+// r[0..n) = a[0..n) * v + carry, returning the limb carried out. r may be a.
+static unsigned mul1(unsigned *r, const unsigned *a, int n, unsigned v, unsigned carry) {
+    return n < SIMD_MIN_LIMBS ? mul1Loop(r, a, n, v, carry) : kernels->mul1(r, a, n, v, carry);
+}
+
+// ===================================
+// Comparison
+// ===================================
+
+void int2048::cut() {
+    for (int i = digits.size()-1; i >= 0; i--) {
+        if (digits[i] != 0) {
+            digits.resize(i+1);
+            return;
+        }
+    }
+    digits.resize(1);
+    digits[0] = 0;
+    signal = true;
+}
+
+int2048 int2048::operator+() const {
+    return int2048(*this);
+}
+
+int2048 int2048::operator-() const {
+    int2048 res(this->digits, !this->signal);
+    res.cut();
+    return res;
+}
+
+// Number of significant limbs (0 for zero).
+int int2048::len() const {
+    for (int i = digits.size()-1; i >= 0; i--) {
+        if (digits[i] != 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+bool operator<(const int2048 &a, const int2048 &b) {
+    if (!a.signal&&b.signal) {
+        return true;
+    }
+    else if (a.signal&&!b.signal) {
+        return false;
+    }
+    else {
+        int cmp = absCmp(a, b);
+        if (cmp < 0) {
+            return a.signal;
+        }
+        else if (cmp > 0) {
+            return !a.signal;
+        }
+        else {
+            return false;
+        }
+    }
+}
+
+bool operator>(const int2048 &a, const int2048 &b) {
+    if (!a.signal&&b.signal) {
+        return false;
+    }
+    else if (a.signal&&!b.signal) {
+        return true;
+    }
+    else {
+        int cmp = absCmp(a, b);
+        if (cmp < 0) {
+            return !a.signal;
+        }
+        else if (cmp > 0) {
+            return a.signal;
+        }
+        else {
+            return false;
+        }
+    }
+}
+
+int absCmp(const int2048 &a, const int2048 &b) {
+    int la = a.len();
+    int lb = b.len();
+    if (la > lb) {
+        return 1;
+    }
+    else if (la < lb) {
+        return -1;
+    }
+    return cmpN(a.digits.data(), b.digits.data(), la);
+}
+
+bool operator!=(const int2048 &a, const int2048 &b) {
+    return !(a==b);
+}
+
+bool operator==(const int2048 &a, const int2048 &b) {
+    if (a.len() == 0 && b.len() == 0) {
+        return true;
+    }
+    return (a.signal == b.signal) && (absCmp(a, b) == 0);
+}
+
+bool operator>=(const int2048 &a, const int2048 &b) {
+    return !(a < b);
+}
+
+bool operator<=(const int2048 &a, const int2048 &b) {
+    return !(a > b);
+}
+
+int2048 & int2048::operator=(const int2048 &a) {
+    digits = a.digits;
+    signal = a.signal;
+    return *this;
+}
+
+// Swapping hands the old buffer to a, so a chain of moves (std::swap,
+// for one) never frees or allocates.
+int2048 & int2048::operator=(int2048 &&a) noexcept {
+    swap(a);
+    return *this;
+}
+
+void int2048::swap(int2048 &a) noexcept {
+    digits.swap(a.digits);
+    std::swap(signal, a.signal);
+}
+
+void swap(int2048 &a, int2048 &b) noexcept {
+    a.swap(b);
+}
+
+// ===================================
+// Addition and subtraction
+// ===================================
+
+// r[0..rn) += a[0..an), an <= rn; the final carry is dropped.
+static void addInto(unsigned *r, int rn, const unsigned *a, int an) {
+    unsigned carry = addN(r, r, a, an);
+    for (int i = an; i < rn && carry; i++) {
+        r[i]++;
+        carry = r[i] == 0;
+    }
+}
+
+// r[0..rn) -= a[0..an), an <= rn and r >= a.
+static void subInto(unsigned *r, int rn, const unsigned *a, int an) {
+    unsigned borrow = subN(r, r, a, an);
+    for (int i = an; i < rn && borrow; i++) {
+        borrow = r[i] == 0;
+        r[i]--;
+    }
+}
+
+// *this += (aSignal ? |a| : -|a|) without a temporary. The buffer only
+// grows when the sum needs a new top limb, so steady-state accumulation
+// reuses its capacity and never allocates. a may alias *this.
+void int2048::addSigned(const int2048 &a, bool aSignal) {
+    int n = a.len();
+    if (n == 0) {
+        return;
+    }
+    if (signal == aSignal || len() == 0) {
+        signal = aSignal;
+        digits.resize(checkedLimbs(std::max(len(), n) + 1LL), 0);
+        addInto(digits.data(), digits.size(), a.digits.data(), n);
+        cut();
+        return;
+    }
+    int cmp = absCmp(*this, a);
+    if (cmp == 0) {
+        digits.assign(1, 0);
+        signal = true;
+    }
+    else if (cmp > 0) {
+        subInto(digits.data(), digits.size(), a.digits.data(), n);
+        cut();
+    }
+    else {
+        digits.resize(n, 0);
+        subN(digits.data(), a.digits.data(), digits.data(), n);
+        signal = aSignal;
+        cut();
+    }
+}
+
+int2048 operator+(const int2048 &a, const int2048 &b) {
+    STAT_SCOPE(STAT_ADD, a.digits.size() + b.digits.size());
+    int2048 res;
+    res.digits.reserve(std::max(a.digits.size(), b.digits.size()) + 1);
+    res = a;
+    res.addSigned(b, b.signal);
+    return res;
+}
+
+int2048 operator-(const int2048 &a, const int2048 &b) {
+    STAT_SCOPE(STAT_SUB, a.digits.size() + b.digits.size());
+    int2048 res;
+    res.digits.reserve(std::max(a.digits.size(), b.digits.size()) + 1);
+    res = a;
+    res.addSigned(b, !b.signal);
+    return res;
+}
+
+int2048 & int2048::operator+=(const int2048 & a) {
+    STAT_SCOPE(STAT_ADD, digits.size() + a.digits.size());
+    addSigned(a, a.signal);
+    return *this;
+}
+
+int2048 & int2048::operator-=(const int2048 & a) {
+    STAT_SCOPE(STAT_SUB, digits.size() + a.digits.size());
+    addSigned(a, !a.signal);
+    return *this;
+}
+
+int2048 &int2048::add(const int2048 & a) {
+    return (*this) += a;
+}
+
+int2048 add(int2048 a, const int2048 & b) {
+    return a + b;
+}
+
+int2048 minus(int2048 a, const int2048 & b) {
+    return a - b;
+}
+
+int2048 & int2048::minus(const int2048 & a) {
+    return (*this) -= a;
+}
+
+int2048 & int2048::operator*=(const int2048 & a) {
+    *this = (*this) * a;
+    return *this;
+}
+
+// ===================================
+// Threads
+// ===================================
+
+#ifdef INT2048_THREADS
+// One parallelFor call: body runs once for every index below count. next,
+// done and error (the first exception a body threw) are guarded by the
+// pool's mutex.
+struct ParallelJob {
+    const std::function<void(int)> *body;
+    int count;
+    int next;
+    int done;
+    std::exception_ptr error;
+};
+
+// Worker threads that help with parallelFor jobs. The caller runs indices
+// of its own job as well and only waits for the ones workers have already
+// taken, so a body may call parallelFor again without deadlocking. If a
+// body throws, the remaining indices are skipped, and the first exception
+// is rethrown by run() once no thread touches the job any more.
+class ThreadPool {
+public:
+    explicit ThreadPool(int workers) {
+        stopping = false;
+        for (int i = 0; i < workers; i++) {
+            threads.emplace_back(&ThreadPool::work, this);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+    }
+
+    void run(int count, const std::function<void(int)> &body) {
+        ParallelJob job = {&body, count, 0, 0, nullptr};
+        std::unique_lock<std::mutex> guard(lock);
+        jobs.push_back(&job);
+        wake.notify_all();
+        while (job.next < count) {
+            execute(&job, claim(&job), guard);
+        }
+        finished.wait(guard, [&] { return job.done == count; });
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::deque<ParallelJob *> jobs;
+    bool stopping;
+
+    // Takes the next index of job and drops the job from the queue once
+    // every index is taken; the caller holds the lock.
+    int claim(ParallelJob *job) {
+        int i = job->next++;
+        if (job->next == job->count) {
+            jobs.erase(std::find(jobs.begin(), jobs.end(), job));
+        }
+        return i;
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            wake.wait(guard, [&] { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            ParallelJob *job = jobs.front();
+            execute(job, claim(job), guard);
+        }
+    }
+
+    // Runs index i of job with the lock released, unless an earlier index
+    // has failed; either way the index counts as done. The caller holds the
+    // lock.
+    void execute(ParallelJob *job, int i, std::unique_lock<std::mutex> &guard) {
+        if (!job->error) {
+            guard.unlock();
+            std::exception_ptr error;
+            try {
+                (*job->body)(i);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            guard.lock();
+            if (error && !job->error) {
+                job->error = error;
+            }
+        }
+        if (++job->done == job->count) {
+            finished.notify_all();
+        }
+    }
+};
+
+static std::unique_ptr<ThreadPool> threadPool;
+#endif
+
+static int threadCount = 1;
+
+// Without INT2048_THREADS there is no pool, and the count stays 1.
+void setThreadCount(int n) {
+#ifdef INT2048_THREADS
+    if (n <= 0) {
+        n = std::max((int)std::thread::hardware_concurrency(), 1);
+    }
+    if (n != threadCount) {
+        threadPool.reset(n > 1 ? new ThreadPool(n - 1) : nullptr);
+        threadCount = n;
+    }
+#else
+    (void)n;
+#endif
+}
+
+int getThreadCount() {
+    return threadCount;
+}
+
+// Runs body(0), ..., body(count - 1), spread over the pool if there is one.
+template <class Body>
+static void parallelFor(int count, const Body &body) {
+#ifdef INT2048_THREADS
+    if (threadPool && count > 1) {
+        threadPool->run(count, std::function<void(int)>(body));
+        return;
+    }
+#endif
+    for (int i = 0; i < count; i++) {
+        body(i);
+    }
+}
+
+// Loops over n cheap elements are only split into pieces of at least this
+// many elements.
+static const int PARALLEL_GRAIN = 1 << 13;
+
+static int parallelTasks(long long n) {
+    return (int)std::max(std::min<long long>(threadCount, n / PARALLEL_GRAIN), 1ll);
+}
+
+// Calls body(lo, hi) on consecutive ranges covering [0, n).
+template <class Body>
+static void parallelRanges(long long n, const Body &body) {
+    int tasks = parallelTasks(n);
+    parallelFor(tasks, [&](int t) {
+        body(n * t / tasks, n * (t + 1) / tasks);
+    });
+}
+
+// ===================================
+// Multiplication
+// ===================================
+
+// Plain O(n*m) product into r[0..an+bn), one row of limb products at a time.
+static void mulBasecase(unsigned *r, const unsigned *a, int an, const unsigned *b, int bn) {
+    std::fill(r, r + an + bn, 0u);
+    for (int i = 0; i < an; i++) {
+        unsigned long long ai = a[i];
+        if (ai == 0) {
+            continue;
+        }
+        unsigned long long carry = 0;
+        for (int j = 0; j < bn; j++) {
+            carry += ai * b[j] + r[i+j];
+            r[i+j] = (unsigned)carry;
+            carry >>= 32;
+        }
+        r[i+bn] = carry;
+    }
+}
+
+static void mulSchoolbookDigits(const LimbVector &a, const LimbVector &b, LimbVector &res) {
+    STAT_SCOPE(STAT_MUL_SCHOOLBOOK, a.size() + b.size());
+    res.resize(a.size() + b.size());
+    mulBasecase(res.data(), a.data(), a.size(), b.data(), b.size());
+}
+
+// |x - y| into r[0..max(xn, yn)), returning true when x < y.
+static bool absDiff(unsigned *r, const unsigned *x, int xn, const unsigned *y, int yn) {
+    int n = std::max(xn, yn);
+    int cmp = 0;
+    for (int i = n - 1; i >= 0 && cmp == 0; i--) {
+        unsigned xi = i < xn ? x[i] : 0;
+        unsigned yi = i < yn ? y[i] : 0;
+        if (xi != yi) {
+            cmp = xi > yi ? 1 : -1;
+        }
+    }
+    if (cmp < 0) {
+        std::swap(x, y);
+        std::swap(xn, yn);
+    }
+    std::copy(x, x + xn, r);
+    std::fill(r + xn, r + n, 0u);
+    subInto(r, n, y, yn);
+    return cmp < 0;
+}
+
+// Karatsuba in the subtractive form: the middle term is
+// a0*b0 + a1*b1 + (a0 - a1)(b1 - b0), so every intermediate fits in n + 1
+// limbs and no carries leak out of the half-size products. a and b hold n
+// limbs each, r receives 2n limbs, and scratch must hold karatsubaScratch(n)
+// limbs; it is the only memory the recursion touches.
+static int karatsubaScratch(int n) {
+    int total = 0;
+    while (n >= KARATSUBA_THRESHOLD) {
+        n -= n / 2;
+        total += 6 * n + 1;
+    }
+    return total;
+}
+
+static void karatsuba(unsigned *r, const unsigned *a, const unsigned *b, int n, unsigned *scratch) {
+    if (n < KARATSUBA_THRESHOLD) {
+        mulBasecase(r, a, n, b, n);
+        return;
+    }
+    int m = n / 2;
+    int h = n - m;
+    unsigned *da = scratch;
+    unsigned *db = scratch + h;
+    unsigned *t = scratch + 2 * h;
+    unsigned *mid = scratch + 4 * h;
+    unsigned *next = scratch + 6 * h + 1;
+    bool negative = absDiff(da, a, m, a + m, h) != absDiff(db, b + m, h, b, m);
+    if (n >= PARALLEL_THRESHOLD && threadCount > 1) {
+        // the three half products write disjoint limbs; each gets its own
+        // scratch
+        int part = karatsubaScratch(h);
+        LimbVector more(2 * part);
+        unsigned *spare[3] = {next, more.data(), more.data() + part};
+        parallelFor(3, [&](int i) {
+            if (i == 0) {
+                karatsuba(r, a, b, m, spare[0]);
+            }
+            else if (i == 1) {
+                karatsuba(r + 2 * m, a + m, b + m, h, spare[1]);
+            }
+            else {
+                karatsuba(t, da, db, h, spare[2]);
+            }
+        });
+    }
+    else {
+        karatsuba(r, a, b, m, next);
+        karatsuba(r + 2 * m, a + m, b + m, h, next);
+        karatsuba(t, da, db, h, next);
+    }
+    std::copy(r + 2 * m, r + 2 * n, mid);
+    mid[2 * h] = 0;
+    addInto(mid, 2 * h + 1, r, 2 * m);
+    if (negative) {
+        subInto(mid, 2 * h + 1, t, 2 * h);
+    }
+    else {
+        addInto(mid, 2 * h + 1, t, 2 * h);
+    }
+    addInto(r + m, 2 * n - m, mid, 2 * h + 1);
+}
+
+// Splits the longer operand into blocks the size of the shorter one so that
+// every Karatsuba call is balanced.
+static void mulKaratsubaDigits(const LimbVector &a, const LimbVector &b, LimbVector &res) {
+    STAT_SCOPE(STAT_MUL_KARATSUBA, a.size() + b.size());
+    const LimbVector &x = a.size() >= b.size() ? a : b;
+    const LimbVector &y = a.size() >= b.size() ? b : a;
+    int n = y.size();
+    LimbVector xs(n);
+    LimbVector part(2 * n);
+    LimbVector scratch(karatsubaScratch(n) + 1);
+    res.assign(x.size() + n, 0);
+    for (int off = 0; off < x.size(); off += n) {
+        int len = std::min(n, (int)x.size() - off);
+        std::copy(x.begin() + off, x.begin() + off + len, xs.begin());
+        std::fill(xs.begin() + len, xs.end(), 0u);
+        karatsuba(part.data(), xs.data(), y.data(), n, scratch.data());
+        addInto(res.data() + off, res.size() - off, part.data(), len + n);
+    }
+}
+
+// NTT over two primes of the form k * 2^t + 1 (both with primitive root 3),
+// recombined with CRT. Limbs are split into 16-bit pieces, so a convolution
+// coefficient is below min(n, m) * 2^32 <= 2^56 < NTT_MOD0 * NTT_MOD1 for
+// any operands that fit in a transform of length 2^25.
+static const unsigned NTT_MOD0 = 469762049u;
+static const unsigned NTT_MOD1 = 167772161u;
+static const int NTT_MAX_LOG = 25;
+
+static unsigned long long powMod(unsigned long long a, unsigned long long e, unsigned long long mod) {
+    unsigned long long r = 1;
+    a %= mod;
+    while (e) {
+        if (e & 1) {
+            r = r * a % mod;
+        }
+        a = a * a % mod;
+        e >>= 1;
+    }
+    return r;
+}
+
+// Arithmetic modulo an NTT prime in Montgomery form (R = 2^32). The modulus
+// is a template parameter so every constant below folds at compile time.
+// Reduction is lazy: both moduli are below 2^29, so values are kept below
+// 2 * mod, sums of two of them still fit in a limb, and a value is only
+// brought below mod once a transform is finished.
+template <unsigned mod>
+struct NttField {
+    static constexpr unsigned negInv() {
+        unsigned x = 1;
+        for (int i = 0; i < 5; i++) {
+            x *= 2 - mod * x;
+        }
+        return 0u - x;
+    }
+    static constexpr unsigned r2() {
+        return (unsigned)((((1ull << 32) % mod) * ((1ull << 32) % mod)) % mod);
+    }
+    // a * b / R, below 2 * mod whenever a * b < R * mod, which holds for
+    // a < 4 * mod and b < mod as well as for a and b below 2 * mod.
+    static unsigned mul(unsigned a, unsigned b) {
+        unsigned long long x = (unsigned long long)a * b;
+        unsigned m = (unsigned)x * negInv();
+        return (x + (unsigned long long)m * mod) >> 32;
+    }
+    // a < 4 * mod to below 2 * mod.
+    static unsigned fold(unsigned a) {
+        return a >= 2 * mod ? a - 2 * mod : a;
+    }
+    // a < 2 * mod to below mod.
+    static unsigned full(unsigned a) {
+        return a >= mod ? a - mod : a;
+    }
+    static unsigned toMont(unsigned a) {
+        return full(mul(a, r2()));
+    }
+};
+
+// Powers of the roots of unity in Montgomery form, below mod: forward[t]
+// holds w^0, ..., w^(2^t - 1) for the primitive 2^(t+1)-th root w, and
+// inverse[t] the same powers of w^-1. Levels are built on first use and
+// then kept; like the decimal powers they come from the heap, and are only
+// appended under the lock, so transforms on any thread read them freely.
+template <unsigned mod>
+struct NttRoots {
+    LimbVector forward[NTT_MAX_LOG];
+    LimbVector inverse[NTT_MAX_LOG];
+    int levels;
+    Mutex lock;
+};
+
+// Fills w[0..half) with successive powers of root, in Montgomery form.
+template <unsigned mod>
+static void nttTwiddles(LimbVector &w, int half, unsigned long long root) {
+    typedef NttField<mod> F;
+    w.resize(half);
+    unsigned step = F::toMont(root);
+    parallelRanges(half, [&](long long lo, long long hi) {
+        unsigned x = F::toMont(powMod(root, lo, mod));
+        for (int k = lo; k < hi; k++) {
+            w[k] = x;
+            x = F::full(F::mul(x, step));
+        }
+    });
+}
+
+// The roots for transforms of length up to 2^log.
+template <unsigned mod>
+static const NttRoots<mod> &nttRoots(int log) {
+    static NttRoots<mod> roots;
+    MutexLock lock(roots.lock);
+    if (roots.levels < log) {
+        ScopedLimbResource heap(nullptr);
+        for (int t = roots.levels; t < log; t++) {
+            unsigned long long root = powMod(3, (mod - 1) >> (t + 1), mod);
+            nttTwiddles<mod>(roots.forward[t], 1 << t, root);
+            nttTwiddles<mod>(roots.inverse[t], 1 << t, powMod(root, mod - 2, mod));
+        }
+        roots.levels = log;
+    }
+    return roots;
+}
+
+static int nttLog(int n) {
+    int log = 0;
+    while ((1 << log) < n) {
+        log++;
+    }
+    return log;
+}
+
+// Forward transform is decimation-in-frequency (natural order in, bit-reversed
+// out) and the inverse is decimation-in-time (bit-reversed in, natural out),
+// so the pair never needs an explicit bit-reversal permutation. Every level
+// but the last three is one pass over the array; those three (halves 4, 2
+// and 1) are done together, sixteen elements at a time. A pass numbers its
+// n / 2 butterflies block by block, and the passes below run butterflies
+// [lo, hi) of one level, so a pass can be split anywhere.
+template <unsigned mod>
+static void nttForwardPass(unsigned *a, const unsigned *w, int half, long long lo, long long hi) {
+    typedef NttField<mod> F;
+    while (lo < hi) {
+        int k = lo % half;
+        int end = std::min<long long>(half, k + hi - lo);
+        unsigned *p = a + lo / half * 2 * half;
+        unsigned *q = p + half;
+        for (int j = k; j < end; j++) {
+            unsigned u = p[j];
+            unsigned v = q[j];
+            p[j] = F::fold(u + v);
+            q[j] = F::mul(u + 2 * mod - v, w[j]);
+        }
+        lo += end - k;
+    }
+}
+
+template <unsigned mod>
+static void nttInversePass(unsigned *a, const unsigned *w, int half, long long lo, long long hi) {
+    typedef NttField<mod> F;
+    while (lo < hi) {
+        int k = lo % half;
+        int end = std::min<long long>(half, k + hi - lo);
+        unsigned *p = a + lo / half * 2 * half;
+        unsigned *q = p + half;
+        for (int j = k; j < end; j++) {
+            unsigned u = p[j];
+            unsigned v = F::mul(q[j], w[j]);
+            p[j] = F::fold(u + v);
+            q[j] = F::fold(u + 2 * mod - v);
+        }
+        lo += end - k;
+    }
+}
+
+// The last three forward levels on groups [lo, hi) of sixteen elements.
+template <unsigned mod>
+static void nttForwardTail(unsigned *a, const NttRoots<mod> &roots, long long lo, long long hi) {
+    for (long long g = lo; g < hi; g++) {
+        for (int t = 2; t >= 0; t--) {
+            nttForwardPass<mod>(a, roots.forward[t].data(), 1 << t, 8 * g, 8 * g + 8);
+        }
+    }
+}
+
+template <unsigned mod>
+static void nttInverseTail(unsigned *a, const NttRoots<mod> &roots, long long lo, long long hi) {
+    for (long long g = lo; g < hi; g++) {
+        for (int t = 0; t <= 2; t++) {
+            nttInversePass<mod>(a, roots.inverse[t].data(), 1 << t, 8 * g, 8 * g + 8);
+        }
+    }
+}
+
+// a[i] = a[i] * b[i] / R for i in [lo, hi).
+template <unsigned mod>
+static void nttMulLoop(unsigned *a, const unsigned *b, long long lo, long long hi) {
+    typedef NttField<mod> F;
+    for (long long i = lo; i < hi; i++) {
+        a[i] = F::mul(a[i], b[i]);
+    }
+}
+
+// acc[i] += x[i] * y[i] / R for i in [lo, hi).
+template <unsigned mod>
+static void nttMulAddLoop(unsigned *acc, const unsigned *x, const unsigned *y, long long lo, long long hi) {
+    typedef NttField<mod> F;
+    for (long long i = lo; i < hi; i++) {
+        acc[i] = F::fold(acc[i] + F::mul(x[i], y[i]));
+    }
+}
+
+// a[i] = a[i] * c / R for i in [lo, hi), fully reduced.
+template <unsigned mod>
+static void nttScaleLoop(unsigned *a, unsigned c, long long lo, long long hi) {
+    typedef NttField<mod> F;
+    for (long long i = lo; i < hi; i++) {
+        a[i] = F::full(F::mul(a[i], c));
+    }
+}
+
+#ifdef INT2048_X86_KERNELS
+// NttField on eight lanes. The 64-bit products of the even and the odd
+// lanes are reduced separately and their high halves blended back together;
+// fold and full compare without a sign bias, since a - 2 * mod (or a - mod)
+// wraps around above a exactly when no subtraction is due.
+template <unsigned mod>
+struct NttFieldAvx {
+    __attribute__((target("avx2")))
+    static __m256i mul(__m256i a, __m256i b) {
+        const __m256i m = _mm256_set1_epi32(mod);
+        const __m256i neg = _mm256_set1_epi32(NttField<mod>::negInv());
+        __m256i even = _mm256_mul_epu32(a, b);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        even = _mm256_add_epi64(even, _mm256_mul_epu32(_mm256_mul_epu32(even, neg), m));
+        odd = _mm256_add_epi64(odd, _mm256_mul_epu32(_mm256_mul_epu32(odd, neg), m));
+        return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa);
+    }
+    __attribute__((target("avx2")))
+    static __m256i fold(__m256i a) {
+        return _mm256_min_epu32(a, _mm256_sub_epi32(a, _mm256_set1_epi32(2 * mod)));
+    }
+    __attribute__((target("avx2")))
+    static __m256i full(__m256i a) {
+        return _mm256_min_epu32(a, _mm256_sub_epi32(a, _mm256_set1_epi32(mod)));
+    }
+    // Forward and inverse butterflies on eight pairs.
+    __attribute__((target("avx2")))
+    static void forward(__m256i &u, __m256i &v, __m256i w) {
+        const __m256i twice = _mm256_set1_epi32(2 * mod);
+        __m256i d = _mm256_sub_epi32(_mm256_add_epi32(u, twice), v);
+        u = fold(_mm256_add_epi32(u, v));
+        v = mul(d, w);
+    }
+    __attribute__((target("avx2")))
+    static void inverse(__m256i &u, __m256i &v, __m256i w) {
+        const __m256i twice = _mm256_set1_epi32(2 * mod);
+        __m256i t = mul(v, w);
+        v = fold(_mm256_sub_epi32(_mm256_add_epi32(u, twice), t));
+        u = fold(_mm256_add_epi32(u, t));
+    }
+};
+
+// nttForwardPass and nttInversePass for half >= 8, with lo and hi multiples
+// of 8, so every vector stays inside one block.
+template <unsigned mod>
+__attribute__((target("avx2")))
+static void nttForwardPassAvx(unsigned *a, const unsigned *w, int half, long long lo, long long hi) {
+    while (lo < hi) {
+        int k = lo % half;
+        int end = std::min<long long>(half, k + hi - lo);
+        unsigned *p = a + lo / half * 2 * half;
+        unsigned *q = p + half;
+        for (int j = k; j < end; j += 8) {
+            __m256i u = _mm256_loadu_si256((const __m256i *)(p + j));
+            __m256i v = _mm256_loadu_si256((const __m256i *)(q + j));
+            NttFieldAvx<mod>::forward(u, v, _mm256_loadu_si256((const __m256i *)(w + j)));
+            _mm256_storeu_si256((__m256i *)(p + j), u);
+            _mm256_storeu_si256((__m256i *)(q + j), v);
+        }
+        lo += end - k;
+    }
+}
+
+template <unsigned mod>
+__attribute__((target("avx2")))
+static void nttInversePassAvx(unsigned *a, const unsigned *w, int half, long long lo, long long hi) {
+    while (lo < hi) {
+        int k = lo % half;
+        int end = std::min<long long>(half, k + hi - lo);
+        unsigned *p = a + lo / half * 2 * half;
+        unsigned *q = p + half;
+        for (int j = k; j < end; j += 8) {
+            __m256i u = _mm256_loadu_si256((const __m256i *)(p + j));
+            __m256i v = _mm256_loadu_si256((const __m256i *)(q + j));
+            NttFieldAvx<mod>::inverse(u, v, _mm256_loadu_si256((const __m256i *)(w + j)));
+            _mm256_storeu_si256((__m256i *)(p + j), u);
+            _mm256_storeu_si256((__m256i *)(q + j), v);
+        }
+        lo += end - k;
+    }
+}
+
+// The last three levels on two blocks of eight, x and y, at once. The
+// lanes are regrouped before each level so that every butterfly pairs a
+// lane of u with the same lane of v: halves of each block for half 4,
+// 64-bit pairs (unpack) for half 2 and single elements (shuffle) for half 1.
+// Half 1 needs no multiplication, as its only twiddle is 1.
+template <unsigned mod>
+__attribute__((target("avx2")))
+static void nttForwardTailAvx(unsigned *a, const NttRoots<mod> &roots, long long lo, long long hi) {
+    typedef NttFieldAvx<mod> V;
+    const unsigned *w4 = roots.forward[2].data();
+    const unsigned *w2 = roots.forward[1].data();
+    const __m256i t4 = _mm256_setr_epi32(w4[0], w4[1], w4[2], w4[3], w4[0], w4[1], w4[2], w4[3]);
+    const __m256i t2 = _mm256_setr_epi32(w2[0], w2[1], w2[0], w2[1], w2[0], w2[1], w2[0], w2[1]);
+    const __m256i twice = _mm256_set1_epi32(2 * mod);
+    for (long long g = lo; g < hi; g++) {
+        unsigned *p = a + 16 * g;
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i y = _mm256_loadu_si256((const __m256i *)(p + 8));
+        __m256i u = _mm256_permute2x128_si256(x, y, 0x20);
+        __m256i v = _mm256_permute2x128_si256(x, y, 0x31);
+        V::forward(u, v, t4);
+        x = _mm256_unpacklo_epi64(u, v);
+        y = _mm256_unpackhi_epi64(u, v);
+        V::forward(x, y, t2);
+        u = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y), 0x88));
+        v = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y), 0xdd));
+        x = V::fold(_mm256_add_epi32(u, v));
+        y = V::fold(_mm256_sub_epi32(_mm256_add_epi32(u, twice), v));
+        u = _mm256_unpacklo_epi32(x, y);
+        v = _mm256_unpackhi_epi32(x, y);
+        x = _mm256_unpacklo_epi64(u, v);
+        y = _mm256_unpackhi_epi64(u, v);
+        _mm256_storeu_si256((__m256i *)p, _mm256_permute2x128_si256(x, y, 0x20));
+        _mm256_storeu_si256((__m256i *)(p + 8), _mm256_permute2x128_si256(x, y, 0x31));
+    }
+}
+
+template <unsigned mod>
+__attribute__((target("avx2")))
+static void nttInverseTailAvx(unsigned *a, const NttRoots<mod> &roots, long long lo, long long hi) {
+    typedef NttFieldAvx<mod> V;
+    const unsigned *w4 = roots.inverse[2].data();
+    const unsigned *w2 = roots.inverse[1].data();
+    const __m256i t4 = _mm256_setr_epi32(w4[0], w4[1], w4[2], w4[3], w4[0], w4[1], w4[2], w4[3]);
+    const __m256i t2 = _mm256_setr_epi32(w2[0], w2[1], w2[0], w2[1], w2[0], w2[1], w2[0], w2[1]);
+    const __m256i twice = _mm256_set1_epi32(2 * mod);
+    for (long long g = lo; g < hi; g++) {
+        unsigned *p = a + 16 * g;
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i y = _mm256_loadu_si256((const __m256i *)(p + 8));
+        __m256i u = _mm256_permute2x128_si256(x, y, 0x20);
+        __m256i v = _mm256_permute2x128_si256(x, y, 0x31);
+        x = _mm256_unpacklo_epi64(u, v);
+        y = _mm256_unpackhi_epi64(u, v);
+        u = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y), 0x88));
+        v = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y), 0xdd));
+        x = V::fold(_mm256_add_epi32(u, v));
+        y = V::fold(_mm256_sub_epi32(_mm256_add_epi32(u, twice), v));
+        u = _mm256_unpacklo_epi32(x, y);
+        v = _mm256_unpackhi_epi32(x, y);
+        V::inverse(u, v, t2);
+        x = _mm256_unpacklo_epi64(u, v);
+        y = _mm256_unpackhi_epi64(u, v);
+        V::inverse(x, y, t4);
+        _mm256_storeu_si256((__m256i *)p, _mm256_permute2x128_si256(x, y, 0x20));
+        _mm256_storeu_si256((__m256i *)(p + 8), _mm256_permute2x128_si256(x, y, 0x31));
+    }
+}
+
+template <unsigned mod>
+__attribute__((target("avx2")))
+static void nttMulLoopAvx(unsigned *a, const unsigned *b, long long lo, long long hi) {
+    for (long long i = lo; i < hi; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        _mm256_storeu_si256((__m256i *)(a + i), NttFieldAvx<mod>::mul(x, y));
+    }
+}
+
+template <unsigned mod>
+__attribute__((target("avx2")))
+static void nttMulAddLoopAvx(unsigned *acc, const unsigned *x, const unsigned *y, long long lo, long long hi) {
+    typedef NttFieldAvx<mod> V;
+    for (long long i = lo; i < hi; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(acc + i));
+        __m256i p = V::mul(_mm256_loadu_si256((const __m256i *)(x + i)), _mm256_loadu_si256((const __m256i *)(y + i)));
+        _mm256_storeu_si256((__m256i *)(acc + i), V::fold(_mm256_add_epi32(s, p)));
+    }
+}
+
+template <unsigned mod>
+__attribute__((target("avx2")))
+static void nttScaleLoopAvx(unsigned *a, unsigned c, long long lo, long long hi) {
+    typedef NttFieldAvx<mod> V;
+    const __m256i scale = _mm256_set1_epi32(c);
+    for (long long i = lo; i < hi; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        _mm256_storeu_si256((__m256i *)(a + i), V::full(V::mul(x, scale)));
+    }
+}
+#endif
+
+// The vector kernels take whole groups of sixteen elements, so transforms
+// and pointwise loops shorter than that stay scalar, and longer ones are
+// split into ranges of such groups.
+static const int NTT_GROUP = 16;
+
+static bool nttVector(int n) {
+#ifdef INT2048_X86_KERNELS
+    return simdLevel == SIMD_AVX2 && n >= NTT_GROUP;
+#else
+    (void)n;
+    return false;
+#endif
+}
+
+// The shorter operand's limb count from which products go through the NTT.
+static int nttThreshold() {
+#ifdef INT2048_X86_KERNELS
+    if (simdLevel == SIMD_AVX2) {
+        return NTT_AVX2_THRESHOLD;
+    }
+#endif
+    return NTT_THRESHOLD;
+}
+
+// One range of a pass, or of the three-level tail, with the vector kernels
+// when vector is set.
+template <unsigned mod>
+static void nttForwardRange(unsigned *a, const NttRoots<mod> &roots, int half, long long lo, long long hi, bool vector) {
+#ifdef INT2048_X86_KERNELS
+    if (vector) {
+        if (half >= 8) {
+            nttForwardPassAvx<mod>(a, roots.forward[nttLog(half)].data(), half, 8 * lo, 8 * hi);
+        }
+        else {
+            nttForwardTailAvx<mod>(a, roots, lo, hi);
+        }
+        return;
+    }
+#endif
+    (void)vector;
+    if (half >= 8) {
+        nttForwardPass<mod>(a, roots.forward[nttLog(half)].data(), half, 8 * lo, 8 * hi);
+    }
+    else {
+        nttForwardTail<mod>(a, roots, lo, hi);
+    }
+}
+
+template <unsigned mod>
+static void nttInverseRange(unsigned *a, const NttRoots<mod> &roots, int half, long long lo, long long hi, bool vector) {
+#ifdef INT2048_X86_KERNELS
+    if (vector) {
+        if (half >= 8) {
+            nttInversePassAvx<mod>(a, roots.inverse[nttLog(half)].data(), half, 8 * lo, 8 * hi);
+        }
+        else {
+            nttInverseTailAvx<mod>(a, roots, lo, hi);
+        }
+        return;
+    }
+#endif
+    (void)vector;
+    if (half >= 8) {
+        nttInversePass<mod>(a, roots.inverse[nttLog(half)].data(), half, 8 * lo, 8 * hi);
+    }
+    else {
+        nttInverseTail<mod>(a, roots, lo, hi);
+    }
+}
+
+// Both take ranges of groups, in units of sixteen elements (eight
+// butterflies of a pass); half < 8 stands for the tail.
+template <unsigned mod>
+static void nttForward(unsigned *a, int n) {
+    const NttRoots<mod> &roots = nttRoots<mod>(nttLog(n));
+    if (n < NTT_GROUP) {
+        for (int half = n / 2; half >= 1; half >>= 1) {
+            nttForwardPass<mod>(a, roots.forward[nttLog(half)].data(), half, 0, n / 2);
+        }
+        return;
+    }
+    bool vector = nttVector(n);
+    for (int half = n / 2; half >= 4; half >>= 1) {
+        parallelRanges(n / NTT_GROUP, [&](long long lo, long long hi) {
+            nttForwardRange<mod>(a, roots, half, lo, hi, vector);
+        });
+    }
+}
+
+template <unsigned mod>
+static void nttInverse(unsigned *a, int n) {
+    const NttRoots<mod> &roots = nttRoots<mod>(nttLog(n));
+    if (n < NTT_GROUP) {
+        for (int half = 1; half < n; half <<= 1) {
+            nttInversePass<mod>(a, roots.inverse[nttLog(half)].data(), half, 0, n / 2);
+        }
+        return;
+    }
+    bool vector = nttVector(n);
+    for (int half = 4; half < n; half <<= 1) {
+        parallelRanges(n / NTT_GROUP, [&](long long lo, long long hi) {
+            nttInverseRange<mod>(a, roots, half, lo, hi, vector);
+        });
+    }
+}
+
+// Runs one of the pointwise loops above over [0, n): body(lo, hi, vector)
+// gets ranges of whole groups, plus a scalar tail when n is not a multiple
+// of NTT_GROUP.
+template <class Body>
+static void nttPointwise(int n, const Body &body) {
+    bool vector = nttVector(n);
+    parallelRanges(n / NTT_GROUP, [&](long long lo, long long hi) {
+        body(NTT_GROUP * lo, NTT_GROUP * hi, vector);
+    });
+    body(n / NTT_GROUP * NTT_GROUP, n, false);
+}
+
+// a = a * b pointwise (a product of transforms; the factor 1 / R it leaves
+// is taken out by nttFinish).
+template <unsigned mod>
+static void nttMul(unsigned *a, const unsigned *b, int n) {
+    nttPointwise(n, [&](long long lo, long long hi, bool vector) {
+#ifdef INT2048_X86_KERNELS
+        if (vector) {
+            nttMulLoopAvx<mod>(a, b, lo, hi);
+            return;
+        }
+#endif
+        (void)vector;
+        nttMulLoop<mod>(a, b, lo, hi);
+    });
+}
+
+// acc += x * y pointwise.
+template <unsigned mod>
+static void nttMulAdd(unsigned *acc, const unsigned *x, const unsigned *y, int n) {
+    nttPointwise(n, [&](long long lo, long long hi, bool vector) {
+#ifdef INT2048_X86_KERNELS
+        if (vector) {
+            nttMulAddLoopAvx<mod>(acc, x, y, lo, hi);
+            return;
+        }
+#endif
+        (void)vector;
+        nttMulAddLoop<mod>(acc, x, y, lo, hi);
+    });
+}
+
+// Inverse transform of a sum of pointwise products, scaled to the plain
+// convolution coefficients below mod. The inputs were never put in
+// Montgomery form, so a product of two transforms carries a factor 1 / R,
+// and the inverse a factor n; multiplying by n^-1 R^2 takes out both.
+template <unsigned mod>
+static void nttFinish(unsigned *a, int n) {
+    nttInverse<mod>(a, n);
+    unsigned c = powMod(n, mod - 2, mod) * NttField<mod>::r2() % mod;
+    nttPointwise(n, [&](long long lo, long long hi, bool vector) {
+#ifdef INT2048_X86_KERNELS
+        if (vector) {
+            nttScaleLoopAvx<mod>(a, c, lo, hi);
+            return;
+        }
+#endif
+        (void)vector;
+        nttScaleLoop<mod>(a, c, lo, hi);
+    });
+}
+
+// Transform of the 16-bit pieces of a[0..an) (zero past the end) into f,
+// which holds n >= 2 * an entries. The pieces go in as they are: they are
+// below either modulus already.
+template <unsigned mod>
+static void nttPieces(const unsigned *a, int an, LimbVector &f, int n) {
+    f.resize(n);
+    unsigned *p = f.data();
+    parallelRanges(n / 2, [&](long long lo, long long hi) {
+        long long mid = std::max(lo, std::min<long long>(hi, an));
+        for (long long i = lo; i < mid; i++) {
+            p[2*i] = a[i] & 0xffff;
+            p[2*i+1] = a[i] >> 16;
+        }
+        std::fill(p + 2 * mid, p + 2 * hi, 0u);
+    });
+    nttForward<mod>(p, n);
+}
+
+// The transforms of one operand under both primes, kept by callers that
+// multiply the same operand many times (the decimal powers).
+struct NttOperand {
+    LimbVector f[2];
+};
+
+// x = the transforms of a[0..an) at length n >= 2 * an.
+static void nttTransform(const unsigned *a, int an, int n, NttOperand &x) {
+    // sized here so the buffers come from the calling thread's resource
+    x.f[0].resize(n);
+    x.f[1].resize(n);
+    parallelFor(2, [&](int p) {
+        if (p == 0) {
+            nttPieces<NTT_MOD0>(a, an, x.f[0], n);
+        }
+        else {
+            nttPieces<NTT_MOD1>(a, an, x.f[1], n);
+        }
+    });
+}
+
+// Recombines the two residues of the first 2 * limbs convolution
+// coefficients into the integer sum c_i 2^(16 i) at res[0..total): limbs
+// limbs from the coefficients and the carry out of the top one above them
+// (dropped if total == limbs, where the caller knows it is zero or does not
+// want it). Each coefficient is x0 + m0 * k with k = (x1 - x0) / m0 modulo
+// m1, which is one Montgomery product by m0^-1 R.
+static void nttRecombine(const LimbVector &r0, const LimbVector &r1, unsigned *res, int limbs, int total) {
+    typedef NttField<NTT_MOD1> F;
+    const unsigned long long m0 = NTT_MOD0;
+    const unsigned inv = powMod(m0, NTT_MOD1 - 2, NTT_MOD1) * (LIMB_BASE % NTT_MOD1) % NTT_MOD1;
+    // every range of limbs is recombined with its own carry chain; the
+    // carries out of the ranges are added in order afterwards
+    int tasks = parallelTasks(limbs);
+    std::vector<unsigned long long> carries(tasks);
+    parallelFor(tasks, [&](int t) {
+        int lo = (long long)limbs * t / tasks;
+        int hi = (long long)limbs * (t + 1) / tasks;
+        unsigned long long carry = 0;
+        for (int i = lo; i < hi; i++) {
+            unsigned half[2];
+            for (int j = 0; j < 2; j++) {
+                unsigned x0 = r0[2*i+j];
+                // x0 < m0 < 3 * m1, so this stays positive and below 4 * m1
+                unsigned k = F::full(F::mul(r1[2*i+j] + 3 * NTT_MOD1 - x0, inv));
+                carry += x0 + m0 * k;
+                half[j] = carry & 0xffff;
+                carry >>= 16;
+            }
+            res[i] = half[0] | half[1] << 16;
+        }
+        carries[t] = carry;
+    });
+    for (int i = limbs; i < total; i++) {
+        res[i] = i - limbs < 2 ? (unsigned)(carries[tasks - 1] >> (32 * (i - limbs))) : 0;
+    }
+    for (int t = 0; t + 1 < tasks; t++) {
+        int at = (long long)limbs * (t + 1) / tasks;
+        unsigned c[2] = {(unsigned)carries[t], (unsigned)(carries[t] >> 32)};
+        addInto(res + at, total - at, c, std::min(2, total - at));
+    }
+}
+
+// res[0..limbs) = the low limbs of the cyclic convolution of the operands
+// transformed in x and y, that is of their product modulo 2^(16n) - 1
+// with the carry out of limb n / 2 dropped rather than wrapped around.
+// x is overwritten; y may be x, which squares it.
+static void nttProduct(NttOperand &x, const NttOperand &y, int limbs, LimbVector &res) {
+    int n = x.f[0].size();
+    parallelFor(2, [&](int p) {
+        if (p == 0) {
+            nttMul<NTT_MOD0>(x.f[0].data(), y.f[0].data(), n);
+            nttFinish<NTT_MOD0>(x.f[0].data(), n);
+        }
+        else {
+            nttMul<NTT_MOD1>(x.f[1].data(), y.f[1].data(), n);
+            nttFinish<NTT_MOD1>(x.f[1].data(), n);
+        }
+    });
+    res.resize(limbs);
+    nttRecombine(x.f[0], x.f[1], res.data(), limbs, limbs);
+}
+
+// Length of the transform that holds a product of the given number of
+// limbs without wrapping around.
+static int nttLength(long long limbs) {
+    if (2 * limbs > (1 << NTT_MAX_LOG)) {
+        throw std::length_error("int2048: operands too large for NTT multiplication");
+    }
+    return 1 << nttLog(2 * limbs);
+}
+
+static void mulNttDigits(const LimbVector &a, const LimbVector &b, LimbVector &res) {
+    STAT_SCOPE(STAT_MUL_NTT, a.size() + b.size());
+    int n = nttLength((long long)a.size() + b.size());
+    NttOperand x, y;
+    nttTransform(a.data(), a.size(), n, x);
+    // a square needs one transform
+    if (&a != &b) {
+        nttTransform(b.data(), b.size(), n, y);
+    }
+    nttProduct(x, &a != &b ? y : x, a.size() + b.size(), res);
+}
+
+// Transform of the 16-bit pieces of a[from..from + block) (zero past the
+// end of a) into f, which already holds 4 * block entries.
+template <unsigned mod>
+static void nttBlock(const LimbVector &a, int from, int block, LimbVector &f) {
+    nttPieces<mod>(a.data() + from, std::min(block, a.size() - from), f, f.size());
+}
+
+// Blockwise NTT product, for operands beyond a single transform and for
+// unbalanced ones. Both operands are cut into blocks of block limbs (a
+// power of two no larger than the shorter operand needs), each transformed
+// once at length 4 * block, which holds the product of two blocks without
+// wrapping around. The shorter operand's kb transforms are kept and the
+// longer one is streamed a block at a time: its products with the kept
+// blocks are summed pointwise into the accumulator of their output block,
+// and output block s, complete once block s of the longer operand has been
+// seen, is inverse transformed, recombined and added into res at limb
+// s * block. A sum is flushed early when one more product could take its
+// coefficients past NTT_MOD0 * NTT_MOD1. Apart from res, memory is 4 kb
+// transforms, all swept sequentially, and every buffer is allocated on the
+// calling thread, so under a MappedLimbResource a product larger than RAM
+// is paged through at disk bandwidth.
+static void mulStreamingDigits(const LimbVector &x, const LimbVector &y, LimbVector &res, int blockLimbs) {
+    STAT_SCOPE(STAT_MUL_STREAMING, x.size() + y.size());
+    const LimbVector &a = x.size() >= y.size() ? x : y;
+    const LimbVector &b = x.size() >= y.size() ? y : x;
+    checkedLimbs((long long)a.size() + b.size());
+    if (b.empty()) {
+        res.assign(a.size(), 0);
+        return;
+    }
+    int block = 1;
+    while (block < b.size() && block < blockLimbs && block < (1 << (NTT_MAX_LOG - 2))) {
+        block <<= 1;
+    }
+    int n = 4 * block;
+    int ka = (a.size() + block - 1) / block;
+    int kb = (b.size() + block - 1) / block;
+    // a coefficient of one block product is below 2 * block * 0xffff^2
+    const unsigned long long piece = 0xffff;
+    unsigned long long bound = ((unsigned long long)NTT_MOD0 * NTT_MOD1 - 1) / (2ull * block * piece * piece);
+    int group = (int)std::min<unsigned long long>(bound, kb);
+
+    std::vector<LimbVector> fb[2];
+    std::vector<LimbVector> acc[2];
+    LimbVector fa[2];
+    for (int p = 0; p < 2; p++) {
+        for (int j = 0; j < kb; j++) {
+            fb[p].emplace_back(n);
+            acc[p].emplace_back(n);
+        }
+        fa[p].resize(n);
+    }
+    std::vector<int> terms(kb, 0);
+    LimbVector chunk(2 * block + 2);
+    res.assign(a.size() + b.size(), 0);
+
+    for (int j = 0; j < kb; j++) {
+        parallelFor(2, [&](int p) {
+            if (p == 0) {
+                nttBlock<NTT_MOD0>(b, j * block, block, fb[0][j]);
+            }
+            else {
+                nttBlock<NTT_MOD1>(b, j * block, block, fb[1][j]);
+            }
+        });
+    }
+    auto flush = [&](int s) {
+        int slot = s % kb;
+        parallelFor(2, [&](int p) {
+            if (p == 0) {
+                nttFinish<NTT_MOD0>(acc[0][slot].data(), n);
+            }
+            else {
+                nttFinish<NTT_MOD1>(acc[1][slot].data(), n);
+            }
+        });
+        nttRecombine(acc[0][slot], acc[1][slot], chunk.data(), 2 * block, chunk.size());
+        // limbs of the chunk past the end of res are zero
+        int at = s * block;
+        addInto(res.data() + at, res.size() - at, chunk.data(), std::min(chunk.size(), res.size() - at));
+        for (int p = 0; p < 2; p++) {
+            std::fill(acc[p][slot].begin(), acc[p][slot].end(), 0u);
+        }
+        terms[slot] = 0;
+    };
+    for (int i = 0; i < ka; i++) {
+        parallelFor(2, [&](int p) {
+            if (p == 0) {
+                nttBlock<NTT_MOD0>(a, i * block, block, fa[0]);
+            }
+            else {
+                nttBlock<NTT_MOD1>(a, i * block, block, fa[1]);
+            }
+        });
+        for (int j = 0; j < kb; j++) {
+            int slot = (i + j) % kb;
+            parallelFor(2, [&](int p) {
+                if (p == 0) {
+                    nttMulAdd<NTT_MOD0>(acc[0][slot].data(), fa[0].data(), fb[0][j].data(), n);
+                }
+                else {
+                    nttMulAdd<NTT_MOD1>(acc[1][slot].data(), fa[1].data(), fb[1][j].data(), n);
+                }
+            });
+            if (++terms[slot] == group) {
+                flush(i + j);
+            }
+        }
+        if (terms[i % kb] > 0) {
+            flush(i);
+        }
+    }
+    for (int s = ka; s < ka + kb - 1; s++) {
+        if (terms[s % kb] > 0) {
+            flush(s);
+        }
+    }
+}
+
+int2048 mulSchoolbook(const int2048 &a, const int2048 &b) {
+    int2048 res;
+    res.signal = a.signal == b.signal;
+    mulSchoolbookDigits(a.digits, b.digits, res.digits);
+    res.cut();
+    return res;
+}
+
+int2048 mulKaratsuba(const int2048 &a, const int2048 &b) {
+    int2048 res;
+    res.signal = a.signal == b.signal;
+    mulKaratsubaDigits(a.digits, b.digits, res.digits);
+    res.cut();
+    return res;
+}
+
+int2048 mulNtt(const int2048 &a, const int2048 &b) {
+    int2048 res;
+    res.signal = a.signal == b.signal;
+    mulNttDigits(a.digits, b.digits, res.digits);
+    res.cut();
+    return res;
+}
+
+int2048 mulStreaming(const int2048 &a, const int2048 &b, int blockLimbs) {
+    int2048 res;
+    res.signal = a.signal == b.signal;
+    mulStreamingDigits(a.digits, b.digits, res.digits, blockLimbs);
+    res.cut();
+    return res;
+}
+
+// Product limbs of a and b into res with the algorithm operator* would use.
+static void mulDigits(const LimbVector &a, const LimbVector &b, LimbVector &res) {
+    checkedLimbs((long long)a.size() + b.size());
+    int n = std::min(a.size(), b.size());
+    if (n < KARATSUBA_THRESHOLD) {
+        mulSchoolbookDigits(a, b, res);
+    }
+    else if (n < nttThreshold()) {
+        mulKaratsubaDigits(a, b, res);
+    }
+    else if (2LL * (a.size() + b.size()) <= (1 << NTT_MAX_LOG)) {
+        mulNttDigits(a, b, res);
+    }
+    else {
+        mulStreamingDigits(a, b, res, STREAM_BLOCK);
+    }
+}
+
+int2048 multiply(const int2048 &a, const int2048 &b) {
+    STAT_SCOPE(STAT_MUL, a.digits.size() + b.digits.size());
+    int2048 res;
+    res.signal = a.signal == b.signal;
+    mulDigits(a.digits, b.digits, res.digits);
+    res.cut();
+    return res;
+}
+
+// acc += a * b (or acc -= a * b when negate is set). When the product has
+// the accumulator's sign and is below the Karatsuba threshold, each row of
+// limb products is added straight into acc's limbs; otherwise the product
+// limbs are built once in scratch and added or subtracted in place.
+void mulAccumulate(int2048 &acc, const int2048 &a, const int2048 &b, bool negate) {
+    STAT_SCOPE(STAT_MUL, a.digits.size() + b.digits.size());
+    int la = a.len();
+    int lb = b.len();
+    if (la == 0 || lb == 0) {
+        return;
+    }
+    bool sign = (a.signal == b.signal) != negate;
+    bool alias = &acc == &a || &acc == &b;
+    if (!alias && std::min(la, lb) < KARATSUBA_THRESHOLD && (acc.signal == sign || acc.len() == 0)) {
+        acc.signal = sign;
+        acc.digits.resize(checkedLimbs(std::max<long long>(acc.len(), (long long)la + lb) + 1), 0);
+        unsigned *r = acc.digits.data();
+        int rn = acc.digits.size();
+        const unsigned *x = a.digits.data();
+        const unsigned *y = b.digits.data();
+        if (la < lb) {
+            std::swap(x, y);
+            std::swap(la, lb);
+        }
+        for (int i = 0; i < lb; i++) {
+            unsigned long long yi = y[i];
+            unsigned long long carry = 0;
+            for (int j = 0; j < la; j++) {
+                carry += yi * x[j] + r[i+j];
+                r[i+j] = (unsigned)carry;
+                carry >>= 32;
+            }
+            for (int k = i + la; k < rn && carry; k++) {
+                carry += r[k];
+                r[k] = (unsigned)carry;
+                carry >>= 32;
+            }
+        }
+        acc.cut();
+        return;
+    }
+    int2048 prod;
+    mulDigits(a.digits, b.digits, prod.digits);
+    prod.cut();
+    acc.addSigned(prod, sign);
+}
+
+int2048 operator*(const int2048 &a, const int2048 &b) {
+    return multiply(a, b);
+}
+
+// ===================================
+// Division
+// ===================================
+
+int2048 & int2048::operator/=(const int2048 & b) {
+    (*this) = (*this) / b;
+    return *this;
+}
+
+// Scalars below SCALAR_LIMIT are a single limb, so every intermediate of the
+// single-pass kernels (limb * v + carry, rem * 2^32 + limb) fits in an
+// unsigned long long. Larger ones take the two-limb kernels below.
+static const long long SCALAR_LIMIT = 1LL << 32;
+
+// Divides the magnitude in u by v in place, returning the remainder.
+static unsigned divSmallDigits(LimbVector &u, unsigned v) {
+    unsigned long long rem = 0;
+    for (int i = (int)u.size() - 1; i >= 0; i--) {
+        rem = (rem << 32) | u[i];
+        u[i] = rem / v;
+        rem %= v;
+    }
+    return rem;
+}
+
+static unsigned modSmallDigits(const LimbVector &u, unsigned v) {
+    unsigned long long rem = 0;
+    for (int i = (int)u.size() - 1; i >= 0; i--) {
+        rem = ((rem << 32) | u[i]) % v;
+    }
+    return rem;
+}
+
+static void mulSmallDigits(LimbVector &u, unsigned v) {
+    unsigned carry = mul1(u.data(), u.data(), u.size(), v, 0);
+    if (carry) {
+        u.push_back(carry);
+    }
+}
+
+static int leadingZeros(unsigned x) {
+    if (x == 0) {
+        return 32;
+    }
+    int n = 0;
+    while (!(x & 0x80000000u)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+// u *= v for a two-limb v, in place; the two new top limbs may be zero.
+// The rows of limb products by the low and the high limb of v keep
+// separate carries, so each sum fits in an unsigned long long.
+static void mulSmall2Digits(LimbVector &u, unsigned long long v) {
+    unsigned long long v0 = (unsigned)v;
+    unsigned long long v1 = v >> 32;
+    int n = u.size();
+    u.resize(n + 2, 0);
+    unsigned long long low = 0;
+    unsigned long long high = 0;
+    unsigned prev = 0;
+    for (int i = 0; i < n + 2; i++) {
+        unsigned x = u[i];
+        low += x * v0;
+        high += prev * v1 + (unsigned)low;
+        u[i] = (unsigned)high;
+        low >>= 32;
+        high >>= 32;
+        prev = x;
+    }
+}
+
+// One step of Algorithm D by a two-limb divisor d with its top bit set:
+// returns the quotient limb of (rem * 2^32 + x) / d and leaves the
+// remainder in rem (rem < d before and after). With only two divisor
+// limbs, the estimate refined against d's low limb is exact.
+static unsigned divStep2(unsigned long long &rem, unsigned x, unsigned long long d) {
+    unsigned long long d1 = d >> 32;
+    unsigned long long d0 = (unsigned)d;
+    unsigned long long q;
+    unsigned long long r;
+    if ((rem >> 32) == d1) {
+        q = 0xffffffffull;
+        r = rem - q * d1;
+    }
+    else {
+        q = rem / d1;
+        r = rem % d1;
+    }
+    while (r < LIMB_BASE && q * d0 > (r << 32 | x)) {
+        q--;
+        r += d1;
+    }
+    // the true remainder is below d < 2^64, so wrapping arithmetic is exact
+    rem = (rem << 32 | x) - q * d;
+    return q;
+}
+
+// Divides the magnitude in u by v (2^32 <= v < 2^64) in place, returning
+// the remainder. The divisor is normalized and the dividend shifted along
+// with it on the fly, so this is still one pass over u.
+static unsigned long long divSmall2Digits(LimbVector &u, unsigned long long v) {
+    int shift = leadingZeros(v >> 32);
+    unsigned long long d = v << shift;
+    int n = u.size();
+    unsigned long long rem = shift ? u[n - 1] >> (32 - shift) : 0;
+    for (int i = n - 1; i >= 0; i--) {
+        unsigned x = u[i] << shift;
+        if (shift && i > 0) {
+            x |= u[i - 1] >> (32 - shift);
+        }
+        u[i] = divStep2(rem, x, d);
+    }
+    return rem >> shift;
+}
+
+static unsigned long long modSmall2Digits(const LimbVector &u, unsigned long long v) {
+    int shift = leadingZeros(v >> 32);
+    unsigned long long d = v << shift;
+    int n = u.size();
+    unsigned long long rem = shift ? u[n - 1] >> (32 - shift) : 0;
+    for (int i = n - 1; i >= 0; i--) {
+        unsigned x = u[i] << shift;
+        if (shift && i > 0) {
+            x |= u[i - 1] >> (32 - shift);
+        }
+        divStep2(rem, x, d);
+    }
+    return rem >> shift;
+}
+
+// Knuth's Algorithm D (TAOCP 4.3.1) on magnitudes. The divisor is shifted
+// so its top bit is set; each quotient limb is then estimated from the top
+// two limbs of the remainder, refined against the third, and is off by at
+// most one after the fused multiply-subtract.
+void absDivmodSchoolbook(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r) {
+    STAT_SCOPE(STAT_DIV_SCHOOLBOOK, a.digits.size() + b.digits.size());
+    LimbVector u(a.digits);
+    LimbVector v(b.digits);
+    while (u.size() > 1 && u.back() == 0) {
+        u.pop_back();
+    }
+    while (v.size() > 1 && v.back() == 0) {
+        v.pop_back();
+    }
+    q.signal = true;
+    r.signal = true;
+    int n = v.size();
+    int m = (int)u.size() - n;
+    if (m < 0 || (m == 0 && u.back() < v.back())) {
+        q.digits.assign(1, 0);
+        r.digits.swap(u);
+        r.cut();
+        return;
+    }
+    if (n == 1) {
+        unsigned rem = divSmallDigits(u, v[0]);
+        q.digits.swap(u);
+        q.cut();
+        r.digits.assign(1, rem);
+        return;
+    }
+    int s = leadingZeros(v[n-1]);
+    u.push_back(0);
+    if (s) {
+        for (int i = n - 1; i > 0; i--) {
+            v[i] = (v[i] << s) | (v[i-1] >> (32 - s));
+        }
+        v[0] <<= s;
+        for (int i = m + n; i > 0; i--) {
+            u[i] = (u[i] << s) | (u[i-1] >> (32 - s));
+        }
+        u[0] <<= s;
+    }
+    q.digits.assign(m + 1, 0);
+    const unsigned long long vTop = v[n-1];
+    const unsigned long long vNext = v[n-2];
+    for (int j = m; j >= 0; j--) {
+        unsigned long long num = ((unsigned long long)u[j+n] << 32) | u[j+n-1];
+        unsigned long long qhat = num / vTop;
+        unsigned long long rhat = num % vTop;
+        while (qhat >= LIMB_BASE || qhat * vNext > ((rhat << 32) | u[j+n-2])) {
+            qhat--;
+            rhat += vTop;
+            if (rhat >= LIMB_BASE) {
+                break;
+            }
+        }
+        long long borrow = 0;
+        for (int i = 0; i < n; i++) {
+            unsigned long long p = qhat * v[i];
+            long long t = (long long)u[i+j] - borrow - (long long)(p & 0xffffffffu);
+            u[i+j] = (unsigned)t;
+            borrow = (long long)(p >> 32) - (t >> 32);
+        }
+        long long t = (long long)u[j+n] - borrow;
+        u[j+n] = (unsigned)t;
+        if (t < 0) {
+            qhat--;
+            unsigned long long carry = 0;
+            for (int i = 0; i < n; i++) {
+                carry += (unsigned long long)u[i+j] + v[i];
+                u[i+j] = (unsigned)carry;
+                carry >>= 32;
+            }
+            u[j+n] += carry;
+        }
+        q.digits[j] = qhat;
+    }
+    q.cut();
+    u.resize(n);
+    if (s) {
+        for (int i = 0; i < n - 1; i++) {
+            u[i] = (u[i] >> s) | (u[i+1] << (32 - s));
+        }
+        u[n-1] >>= s;
+    }
+    r.digits.swap(u);
+    r.cut();
+}
+
+// floor(2^(64n) / b) for a divisor of exactly n limbs whose top bit is
+// set. The reciprocal of the top half of b is refined by one Newton step
+// x' = 2x - b*x^2 and then corrected against the exact remainder, so every
+// level stays exact; normalization keeps that correction to a few steps.
+int2048 reciprocal(const int2048 &b) {
+    int n = b.digits.size();
+    if (n <= NEWTON_BASE) {
+        int2048 q, r;
+        absDivmodSchoolbook(int2048(1) << (2 * n), b, q, r);
+        return q;
+    }
+    int k = n / 2 + 1;
+    int2048 x = reciprocal(b >> (n - k));
+    int2048 y = (x + x) << (n - k);
+    y -= (b * (x * x)) >> (2 * k);
+    int2048 r = int2048(1) << (2 * n);
+    submul(r, b, y);
+    while (!r.signal) {
+        y -= int2048(1);
+        r += b;
+    }
+    while (absCmp(r, b) >= 0) {
+        y += int2048(1);
+        r -= b;
+    }
+    return y;
+}
+
+// |a| / |b| as floor(|a| * reciprocal(|b|) / 2^(64n)), followed by a small
+// correction. Both operands are scaled so the divisor's top bit is set, and
+// a dividend longer than 2n limbs is handled by shifting both up; neither
+// changes the quotient.
+void absDivmodNewton(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r) {
+    STAT_SCOPE(STAT_DIV_NEWTON, a.digits.size() + b.digits.size());
+    int2048 x(a.digits, true);
+    int2048 d(b.digits, true);
+    x.cut();
+    d.cut();
+    long long f = 1LL << leadingZeros(d.digits.back());
+    x *= f;
+    d *= f;
+    int s = std::max((int)x.digits.size() - 2 * (int)d.digits.size(), 0);
+    int n = d.digits.size() + s;
+    q = (x * reciprocal(d << s)) >> (2 * n - s);
+    r = x;
+    submul(r, q, d);
+    while (!r.signal) {
+        q -= int2048(1);
+        r += d;
+    }
+    while (absCmp(r, d) >= 0) {
+        q += int2048(1);
+        r -= d;
+    }
+    r /= f;
+}
+
+static int2048 lowLimbs(const int2048 &a, int k) {
+    return a - ((a >> k) << k);
+}
+
+static void bzDiv3n2n(const int2048 &a, const int2048 &b, int h, int2048 &q, int2048 &r);
+
+// Burnikel-Ziegler 2n/1n step: a < b * 2^(32n), b has n limbs and its top
+// bit is set. Odd or small sizes go to Algorithm D.
+static void bzDiv2n1n(const int2048 &a, const int2048 &b, int n, int2048 &q, int2048 &r) {
+    if (n % 2 || n <= BZ_BASE) {
+        absDivmodSchoolbook(a, b, q, r);
+        return;
+    }
+    int h = n / 2;
+    int2048 q1, r1, q2;
+    bzDiv3n2n(a >> h, b, h, q1, r1);
+    bzDiv3n2n((r1 << h) + lowLimbs(a, h), b, h, q2, r);
+    q = (q1 << h) + q2;
+}
+
+// 3n/2n step on h-limb parts: a = [a1 a2 a3], b = [b1 b2]. The quotient is
+// estimated from [a1 a2] / b1 and is at most two too large.
+static void bzDiv3n2n(const int2048 &a, const int2048 &b, int h, int2048 &q, int2048 &r) {
+    int2048 a12 = a >> h;
+    int2048 b1 = b >> h;
+    int2048 r1;
+    if (a12 >> h < b1) {
+        bzDiv2n1n(a12, b1, h, q, r1);
+    }
+    else {
+        q = (int2048(1) << h) - int2048(1);
+        r1 = a12 - (b1 << h) + b1;
+    }
+    r = (r1 << h) + lowLimbs(a, h);
+    submul(r, q, lowLimbs(b, h));
+    while (r < int2048(0)) {
+        q -= int2048(1);
+        r += b;
+    }
+}
+
+// |a| / |b| by Burnikel-Ziegler. The divisor is shifted so its top bit is
+// set and padded to m * 2^k limbs with m <= BZ_BASE; the dividend is then
+// divided block by block with the 2n/1n recursion.
+void absDivmodBurnikelZiegler(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r) {
+    STAT_SCOPE(STAT_DIV_BURNIKEL_ZIEGLER, a.digits.size() + b.digits.size());
+    int2048 x(a.digits, true);
+    int2048 d(b.digits, true);
+    x.cut();
+    d.cut();
+    int n = d.digits.size();
+    if (n <= BZ_BASE || absCmp(x, d) < 0) {
+        absDivmodSchoolbook(x, d, q, r);
+        return;
+    }
+    int k = 0;
+    while ((n >> k) > BZ_BASE) {
+        k++;
+    }
+    int block = ((n + (1 << k) - 1) >> k) << k;
+    int s = block - n;
+    long long f = 1LL << leadingZeros(d.digits.back());
+    d = (d * f) << s;
+    x = (x * f) << s;
+    int t = (x.digits.size() + block - 1) / block;
+    if (absCmp(x >> ((t - 1) * block), d) >= 0) {
+        t++;
+    }
+    if (t < 2) {
+        t = 2;
+    }
+    int2048 z = x >> ((t - 2) * block);
+    q = int2048(0);
+    for (int i = t - 2; i >= 0; i--) {
+        int2048 qi, ri;
+        bzDiv2n1n(z, d, block, qi, ri);
+        q = (q << block) + qi;
+        if (i > 0) {
+            z = (ri << block) + lowLimbs(x >> ((i - 1) * block), block);
+        }
+        else {
+            r = ri;
+        }
+    }
+    r = (r >> s) / f;
+}
+
+static DivisionStrategy divisionStrategy = DIVISION_AUTO;
+
+void setDivisionStrategy(DivisionStrategy strategy) {
+    divisionStrategy = strategy;
+}
+
+void absDivmod(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r) {
+    int n = b.digits.size();
+    int m = a.digits.size();
+    switch (divisionStrategy) {
+    case DIVISION_SCHOOLBOOK:
+        absDivmodSchoolbook(a, b, q, r);
+        return;
+    case DIVISION_NEWTON:
+        absDivmodNewton(a, b, q, r);
+        return;
+    case DIVISION_BURNIKEL_ZIEGLER:
+        absDivmodBurnikelZiegler(a, b, q, r);
+        return;
+    default:
+        break;
+    }
+    if (n < BZ_THRESHOLD || m - n < BZ_THRESHOLD) {
+        absDivmodSchoolbook(a, b, q, r);
+    }
+    else if (n < NEWTON_THRESHOLD) {
+        absDivmodBurnikelZiegler(a, b, q, r);
+    }
+    else {
+        absDivmodNewton(a, b, q, r);
+    }
+}
+
+// Signed division with floor semantics: the quotient is rounded towards
+// negative infinity and the remainder takes the sign of the divisor.
+void floorDivmod(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r) {
+    STAT_SCOPE(STAT_DIV, a.digits.size() + b.digits.size());
+    bool aSignal = a.signal;
+    bool bSignal = b.signal;
+    int2048 d(b.digits, true);
+    absDivmod(a, b, q, r);
+    bool exact = r.len() == 0;
+    if (aSignal != bSignal) {
+        if (!exact) {
+            q += int2048(1);
+            r = d - r;
+        }
+        q.signal = false;
+        q.cut();
+    }
+    r.signal = bSignal;
+    r.cut();
+}
+
+int2048 operator/(int2048 a, const int2048 & b) {
+    int2048 q, r;
+    floorDivmod(a, b, q, r);
+    return q;
+}
+
+// Shifts by whole limbs, i.e. multiplies or floor-divides |a| by 2^(32p).
+int2048 operator<<(int2048 a, int p) {
+    if (a.len() == 0) {
+        return a;
+    }
+    checkedLimbs((long long)a.len() + p);
+    a.digits.insert(a.digits.begin(), p, 0);
+    return a;
+}
+
+int2048 operator>>(int2048 a, int p) {
+    if (p >= a.digits.size()) {
+        return int2048(0);
+    }
+    a.digits.erase(a.digits.begin(), a.digits.begin() + p);
+    a.cut();
+    return a;
+}
+
+int2048 & int2048::operator%=(const int2048 & b) {
+    int2048 q;
+    floorDivmod(*this, b, q, *this);
+    return *this;
+}
+
+int2048 operator%(int2048 a, const int2048 & b) {
+    a %= b;
+    return a;
+}
+
+// Adds one to the magnitude in u.
+static void incrementDigits(LimbVector &u) {
+    for (int i = 0; i < u.size(); i++) {
+        if (++u[i] != 0) {
+            return;
+        }
+    }
+    u.push_back(1);
+}
+
+// Scalar forms of *, / and %. Each is one pass over the limbs in place,
+// with the one-limb kernels below SCALAR_LIMIT and the two-limb ones above
+// it, so no long long ever becomes an int2048.
+int2048 & int2048::operator*=(long long v) {
+    unsigned long long m = v < 0 ? 0ull - v : v;
+    if (v < 0) {
+        signal = !signal;
+    }
+    if (m < SCALAR_LIMIT) {
+        mulSmallDigits(digits, m);
+    }
+    else {
+        mulSmall2Digits(digits, m);
+    }
+    cut();
+    return *this;
+}
+
+int2048 & int2048::operator/=(long long v) {
+    unsigned long long m = v < 0 ? 0ull - v : v;
+    bool negative = signal != (v > 0);
+    unsigned long long rem = m < SCALAR_LIMIT ? divSmallDigits(digits, m) : divSmall2Digits(digits, m);
+    if (negative && rem) {
+        incrementDigits(digits);
+    }
+    signal = !negative;
+    cut();
+    return *this;
+}
+
+int2048 & int2048::operator%=(long long v) {
+    unsigned long long m = v < 0 ? 0ull - v : v;
+    unsigned long long rem = m < SCALAR_LIMIT ? modSmallDigits(digits, m) : modSmall2Digits(digits, m);
+    if (rem && signal != (v > 0)) {
+        rem = m - rem;
+    }
+    digits.assign(2, 0);
+    digits[0] = (unsigned)rem;
+    digits[1] = rem >> 32;
+    signal = v > 0;
+    cut();
+    return *this;
+}
+
+int2048 operator*(int2048 a, long long v) {
+    a *= v;
+    return a;
+}
+
+int2048 operator*(long long v, int2048 a) {
+    a *= v;
+    return a;
+}
+
+int2048 operator/(int2048 a, long long v) {
+    a /= v;
+    return a;
+}
+
+int2048 operator%(int2048 a, long long v) {
+    a %= v;
+    return a;
+}
+
+// ===================================
+// Fused multiply-add and divmod
+// ===================================
+
+void addmul(int2048 &acc, const int2048 &x, const int2048 &y) {
+    mulAccumulate(acc, x, y, false);
+}
+
+void submul(int2048 &acc, const int2048 &x, const int2048 &y) {
+    mulAccumulate(acc, x, y, true);
+}
+
+// acc += x * v (acc -= x * v when negate is set) in one pass over x. When
+// the product's sign differs from acc the pass subtracts instead, and a
+// borrow out of the top limb means the result changed sign, which a final
+// two's complement pass fixes up.
+void mulAccumulate(int2048 &acc, const int2048 &x, long long v, bool negate) {
+    if (v >= SCALAR_LIMIT || v <= -SCALAR_LIMIT) {
+        mulAccumulate(acc, x, int2048(v), negate);
+        return;
+    }
+    int n = x.len();
+    if (n == 0 || v == 0) {
+        return;
+    }
+    bool sign = (x.signal == (v > 0)) != negate;
+    unsigned long long m = v < 0 ? -v : v;
+    if (acc.len() == 0) {
+        acc.signal = sign;
+    }
+    acc.digits.resize(std::max(acc.len(), n) + 1, 0);
+    unsigned *r = acc.digits.data();
+    const unsigned *p = x.digits.data();
+    int rn = acc.digits.size();
+    if (acc.signal == sign) {
+        unsigned long long carry = 0;
+        for (int i = 0; i < n; i++) {
+            carry += m * p[i] + r[i];
+            r[i] = (unsigned)carry;
+            carry >>= 32;
+        }
+        for (int i = n; i < rn && carry; i++) {
+            carry += r[i];
+            r[i] = (unsigned)carry;
+            carry >>= 32;
+        }
+    }
+    else {
+        unsigned long long borrow = 0;
+        for (int i = 0; i < n; i++) {
+            unsigned long long t = m * p[i] + borrow;
+            unsigned lo = (unsigned)t;
+            borrow = (t >> 32) + (r[i] < lo);
+            r[i] -= lo;
+        }
+        for (int i = n; i < rn && borrow; i++) {
+            unsigned lo = (unsigned)borrow;
+            borrow = (borrow >> 32) + (r[i] < lo);
+            r[i] -= lo;
+        }
+        if (borrow) {
+            // r holds 2^(32 rn) - |result|
+            unsigned carry = 1;
+            for (int i = 0; i < rn; i++) {
+                r[i] = ~r[i] + carry;
+                carry = carry && r[i] == 0;
+            }
+            acc.signal = sign;
+        }
+    }
+    acc.cut();
+}
+
+void addmul(int2048 &acc, const int2048 &x, long long v) {
+    mulAccumulate(acc, x, v, false);
+}
+
+void submul(int2048 &acc, const int2048 &x, long long v) {
+    mulAccumulate(acc, x, v, true);
+}
+
+// Both results of one floor division; q and r must be distinct objects but
+// either may alias a or b.
+void divmod(const int2048 &a, const int2048 &b, int2048 &q, int2048 &r) {
+    floorDivmod(a, b, q, r);
+}
+
+void divmod(const int2048 &a, long long v, int2048 &q, long long &r) {
+    unsigned long long m = v < 0 ? 0ull - v : v;
+    bool negative = a.signal != (v > 0) && a.len() > 0;
+    q = a;
+    unsigned long long rem = m < SCALAR_LIMIT ? divSmallDigits(q.digits, m) : divSmall2Digits(q.digits, m);
+    if (negative && rem) {
+        incrementDigits(q.digits);
+        rem = m - rem;
+    }
+    q.signal = !negative;
+    q.cut();
+    r = v > 0 ? (long long)rem : -(long long)rem;
+}
+
+// ===================================
+// Decimal conversion
+// ===================================
+
+// Decimal strings are converted by splitting them around
+// 10^(DECIMAL_BASE_DIGITS * 2^i), so both directions cost O(M(n) log n).
+// Parsing multiplies the value of the high digits by the power and adds the
+// low ones. Printing runs a scaled remainder tree instead of dividing: it
+// carries a binary fraction approximating y / 10^m for each piece y of m
+// digits, and one product with 10^(m/2) yields the fractions of both
+// halves. Pieces of at most DECIMAL_BASE_DIGITS digits (a multiple of nine)
+// use quadratic loops that move nine digits (one 32-bit word) per step.
+static const int DECIMAL_BASE_DIGITS = 576;
+static const unsigned DECIMAL_CHUNK = 1000000000u;
+
+// Fractions carry DECIMAL_GUARD limbs more than the digits they stand for
+// need, which keeps the error a tree of truncated products accumulates far
+// below one unit of the last digit.
+static const int DECIMAL_GUARD = 2;
+
+// 10^(DECIMAL_BASE_DIGITS * 2^i) for i = 0, 1, ..., extended by squaring
+// until the last one has at least limbs limbs. Every power is multiplied at
+// a handful of transform lengths over and over, so its transforms are kept
+// too, indexed by the log of the length. Printing also wants the reciprocal
+// of the top power: 2 * power * scale has its top bit set, and inverse is
+// the reciprocal of that shifted up DECIMAL_GUARD limbs, computed on first
+// use. The table is kept between calls, so repeated conversions of similar
+// sizes never rebuild any of it; since it outlives any LimbResource a caller
+// installs, its limbs always come from the heap. Any number of threads
+// convert at once: levels are only appended, and reciprocals and transforms
+// only filled in, under the table's lock, and nothing changes again once it
+// is there. DECIMAL_LEVELS is more than any LimbVector can reach.
+static const int DECIMAL_LEVELS = 32;
+
+struct DecimalPower {
+    LimbVector power;
+    NttOperand powerTransforms[NTT_MAX_LOG + 1];
+    long long scale;
+    LimbVector inverse;
+    NttOperand inverseTransforms[NTT_MAX_LOG + 1];
+};
+
+struct DecimalPowerTable {
+    DecimalPower levels[DECIMAL_LEVELS];
+    int count;
+    Mutex lock;
+};
+
+static DecimalPowerTable decimalTable;
+
+// u = u * scale + add in a single pass.
+static void mulAddSmallDigits(LimbVector &u, unsigned scale, unsigned add) {
+    unsigned carry = mul1(u.data(), u.data(), u.size(), scale, add);
+    if (carry) {
+        u.push_back(carry);
+    }
+}
+
+// Extends the table until its last power has at least limbs limbs, and
+// returns the number of levels.
+static int decimalPowers(int limbs) {
+    MutexLock lock(decimalTable.lock);
+    int n = decimalTable.count;
+    if (n > 0 && decimalTable.levels[n - 1].power.size() >= limbs) {
+        return n;
+    }
+    ScopedLimbResource heap(nullptr);
+    if (n == 0) {
+        LimbVector p(1, 1);
+        for (int i = 0; i < DECIMAL_BASE_DIGITS / 9; i++) {
+            mulAddSmallDigits(p, DECIMAL_CHUNK, 0);
+        }
+        decimalTable.levels[n++].power = std::move(p);
+    }
+    while (decimalTable.levels[n - 1].power.size() < limbs) {
+        const LimbVector &p = decimalTable.levels[n - 1].power;
+        LimbVector &q = decimalTable.levels[n].power;
+        mulDigits(p, p, q);
+        while (q.back() == 0) {
+            q.pop_back();
+        }
+        n++;
+    }
+    decimalTable.count = n;
+    return n;
+}
+
+// res[0..limbs) = the low limbs of a[0..an) * y. Through the NTT the
+// product is taken modulo 2^(32 L) - 1 for some L >= span, with the carry
+// out of the top dropped rather than wrapped around: that is the exact
+// product when it has at most span limbs, and a caller passing a smaller
+// span only reads limbs the wrapped part cannot reach. y's transforms are
+// kept in transforms.
+static void decimalProduct(const unsigned *a, int an, const LimbVector &y, NttOperand *transforms, int span, int limbs, LimbVector &res) {
+    // with y's transforms cached and the product cut to span limbs, the NTT
+    // pays off from far shorter operands than in operator*
+    if (std::min(an, y.size()) < nttThreshold() / 8) {
+        LimbVector x(an);
+        std::copy(a, a + an, x.begin());
+        mulDigits(x, y, res);
+        res.resize(limbs);
+        return;
+    }
+    int n = nttLength(span);
+    NttOperand &t = transforms[nttLog(n)];
+    {
+        MutexLock lock(decimalTable.lock);
+        if (t.f[0].empty()) {
+            ScopedLimbResource heap(nullptr);
+            nttTransform(y.data(), y.size(), n, t);
+        }
+    }
+    NttOperand x;
+    nttTransform(a, an, n, x);
+    nttProduct(x, t, limbs, res);
+}
+
+// res = the value of the n digits at s, with no zero limbs on top.
+static void parseDecimal(const char *s, int n, DecimalPower *powers, LimbVector &res) {
+    if (n <= DECIMAL_BASE_DIGITS) {
+        LimbVector u(1, 0);
+        u.reserve(n / 9 + 2);
+        // a short first chunk keeps every later chunk exactly nine digits
+        int first = n % 9 ? n % 9 : 9;
+        for (int i = 0; i < n; ) {
+            int end = i == 0 ? std::min(first, n) : i + 9;
+            unsigned chunk = 0;
+            unsigned scale = 1;
+            for (; i < end; i++) {
+                chunk = chunk * 10 + (s[i] - '0');
+                scale *= 10;
+            }
+            mulAddSmallDigits(u, scale, chunk);
+        }
+        res.swap(u);
+        return;
+    }
+    int i = 0;
+    while ((long long)DECIMAL_BASE_DIGITS << (i + 1) < n) {
+        i++;
+    }
+    int low = DECIMAL_BASE_DIGITS << i;
+    parseDecimal(s + n - low, low, powers, res);
+    LimbVector high;
+    parseDecimal(s, n - low, powers, high);
+    if (high.back() != 0) {
+        // high * 10^low has more limbs than the low part, and adding that
+        // cannot carry out of them
+        DecimalPower &p = powers[i];
+        int span = high.size() + p.power.size();
+        LimbVector prod;
+        decimalProduct(high.data(), high.size(), p.power, p.powerTransforms, span, span, prod);
+        addInto(prod.data(), span, res.data(), res.size());
+        while (prod.back() == 0) {
+            prod.pop_back();
+        }
+        res.swap(prod);
+    }
+}
+
+// Limbs of a fraction that determines digits digits, with the guard limbs:
+// a limb holds 32 log10(2) > 9.63 digits.
+static int fractionLimbs(int digits) {
+    return (int)(digits / 9.63) + 1 + DECIMAL_GUARD;
+}
+
+// Adds d to the decimal number in [begin, end), modulo 10^(end - begin).
+static void addDecimal(char *begin, char *end, int d) {
+    for (char *p = end; d != 0 && p > begin; ) {
+        int v = *--p - '0' + d;
+        d = v >= 0 ? v / 10 : -((9 - v) / 10);
+        *p = char('0' + v - 10 * d);
+    }
+}
+
+// The nine digits before end, as a number.
+static unsigned lastChunk(const char *end) {
+    unsigned v = 0;
+    for (const char *p = end - 9; p < end; p++) {
+        v = v * 10 + (*p - '0');
+    }
+    return v;
+}
+
+// Corrects the digits in [begin, end), at least nine of them, which are at
+// most a few units off a number whose low limb is low: 2^9 divides 10^9, so
+// the last nine digits tell the difference modulo 2^9.
+static void fixDecimal(char *begin, char *end, unsigned low) {
+    int d = (low - lastChunk(end)) & 511;
+    addDecimal(begin, end, d < 256 ? d : d - 512);
+}
+
+// Writes the m = DECIMAL_BASE_DIGITS << level digits of y into
+// [end - m, end), given the fractionLimbs(m) limbs f of a fraction that
+// approximates (y + 1/2) / 10^m. The fraction may be a unit off, and the
+// digits written may be a unit off too, modulo 10^m: callers correct them
+// with fixDecimal. The high half of y gets f itself, cut down to its own
+// precision, and the low half the fractional part of f * 10^(m/2), whose
+// integer part is the high half, which then corrects the high half's
+// digits. Only those limbs of the product are read, so it may wrap around
+// onto the ones below them. f is used up: nothing reads it once the high
+// half is written, so the digit loops work on it in place.
+static void writeFraction(unsigned *f, int level, char *end, DecimalPower *powers) {
+    int m = DECIMAL_BASE_DIGITS << level;
+    int k = fractionLimbs(m);
+    // below 10^-m the fraction stands for zero
+    if (std::find_if(f + DECIMAL_GUARD, f + k, [](unsigned v) { return v != 0; }) == f + k) {
+        std::fill(end - m, end, '0');
+        return;
+    }
+    if (level == 0) {
+        char *p = end - m;
+        int lo = 0;
+        for (int left = m; left > 0; left -= 9) {
+            unsigned chunk = mul1(f + lo, f + lo, k - lo, DECIMAL_CHUNK, 0);
+            for (int j = 8; j >= 0; j--) {
+                p[j] = char('0' + chunk % 10);
+                chunk /= 10;
+            }
+            p += 9;
+            // fewer digits left need fewer limbs
+            lo = std::max(lo, k - fractionLimbs(left - 9));
+        }
+        return;
+    }
+    int half = m / 2;
+    int kh = fractionLimbs(half);
+    DecimalPower &p = powers[level - 1];
+    LimbVector g;
+    decimalProduct(f, k, p.power, p.powerTransforms, std::max(k + 1, p.power.size() + kh), k + 1, g);
+    writeFraction(f + k - kh, level - 1, end - half, powers);
+    fixDecimal(end - m, end - half, g[k]);
+    writeFraction(g.data() + k - kh, level - 1, end, powers);
+}
+
+// Number of significant limbs of the magnitude x.
+static int significantLimbs(const LimbVector &x) {
+    int n = x.size();
+    while (n > 0 && x[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+// The level of the smallest cached power above the magnitude x, where
+// writeDecimal starts; 0 for numbers it prints directly. The table must
+// already have a power above x.
+static int decimalLevel(const LimbVector &x) {
+    int n = significantLimbs(x);
+    int level = 0;
+    for (;; level++) {
+        const LimbVector &p = decimalTable.levels[level].power;
+        if (p.size() > n || (p.size() == n && cmpN(p.data(), x.data(), n) > 0)) {
+            return level;
+        }
+    }
+}
+
+// Number of digits writeDecimal needs to write the magnitude x.
+static int decimalWidth(const LimbVector &x) {
+    int level = decimalLevel(x);
+    // 32 * log10(2) < 9.64 decimal digits per limb
+    return level > 0 ? DECIMAL_BASE_DIGITS << level : (int)(significantLimbs(x) * 9.64) + 1;
+}
+
+// Writes |x| into [begin, end) as exactly end - begin digits, zero-padded
+// on the left; the caller guarantees the range is at least decimalWidth(x)
+// digits wide. Above 10^DECIMAL_BASE_DIGITS the remainder tree starts from
+// a fraction for (|x| + 1/2) / 10^M, with 10^M the smallest cached power
+// above |x|, from one product with the power's reciprocal.
+void writeDecimal(const int2048 &x, char *begin, char *end) {
+    int level = decimalLevel(x.digits);
+    if (level == 0) {
+        LimbVector u(x.digits);
+        char *p = end;
+        while (u.size() > 1 || u[0] != 0) {
+            unsigned rem = divSmallDigits(u, DECIMAL_CHUNK);
+            while (u.size() > 1 && u.back() == 0) {
+                u.pop_back();
+            }
+            for (int j = 0; j < 9 && p > begin; j++) {
+                *--p = char('0' + rem % 10);
+                rem /= 10;
+            }
+        }
+        std::fill(begin, p, '0');
+        return;
+    }
+    DecimalPower &p = decimalTable.levels[level];
+    {
+        MutexLock lock(decimalTable.lock);
+        if (p.inverse.empty()) {
+            ScopedLimbResource heap(nullptr);
+            int2048 twice(p.power, true);
+            twice += twice;
+            p.scale = 1LL << leadingZeros(twice.digits.back());
+            p.inverse = reciprocal(twice * p.scale << DECIMAL_GUARD).digits;
+        }
+    }
+    // with n limbs in 2 * power, X * inverse / 2^(32 (2n + DECIMAL_GUARD))
+    // approximates (|x| + 1/2) / 10^M for X = (2|x| + 1) * scale
+    int n = p.power.size() + (p.power.back() >> 31);
+    int top = 2 * n + DECIMAL_GUARD;
+    int2048 X(x.digits, true);
+    X.cut();
+    X += X;
+    X += int2048(1);
+    X *= p.scale;
+    LimbVector t;
+    decimalProduct(X.digits.data(), X.len(), p.inverse, p.inverseTransforms, n + p.inverse.size(), top, t);
+    int m = DECIMAL_BASE_DIGITS << level;
+    writeFraction(t.data() + top - fractionLimbs(m), level, end, decimalTable.levels);
+    fixDecimal(end - m, end, x.digits[0]);
+    std::fill(begin, end - m, '0');
+}
+
+void int2048::read(const std::string & num) {
+    STAT_SCOPE(STAT_READ, 0);
+    std::size_t p = 0;
+    bool negative = false;
+    if (p < num.size() && num[p] == '-') {
+        negative = true;
+        p++;
+    }
+    while (p + 1 < num.size() && num[p] == '0') {
+        p++;
+    }
+    // digit positions are ints as well
+    if (num.size() - p > (std::size_t)INT_MAX) {
+        throw std::length_error("int2048: more than INT_MAX decimal digits");
+    }
+    int n = num.size() - p;
+    // enough powers for the top split, which is at about n / 2 digits
+    decimalPowers(n / 19 + 1);
+    parseDecimal(num.data() + p, n, decimalTable.levels, digits);
+    signal = !negative;
+    cut();
+    STAT_LIMBS(STAT_READ, digits.size());
+}
+
+void int2048::print() {
+    std::cout << *this;
+}
+
+std::istream &operator>>(std::istream &is, int2048 &s) {
+    std::string str;
+    is >> str;
+    s.read(str);
+    return is;
 }
 
 std::ostream &operator<<(std::ostream &os, const int2048 &n) {
-    for (int i = n.digits.size()-1; i >= 0; i--) {
-        if (n.digits[i] != 0) {
-            if (!n.signal) {
-                os << '-';
+    STAT_SCOPE(STAT_WRITE, n.digits.size());
+    int2048 x(n.digits, true);
+    x.cut();
+    // a power above |x|
+    decimalPowers(x.len() + 1);
+    std::vector<char> buf(decimalWidth(x.digits) + 1);
+    writeDecimal(x, buf.data() + 1, buf.data() + buf.size());
+    char *p = buf.data() + 1;
+    char *end = buf.data() + buf.size();
+    while (p + 1 < end && *p == '0') {
+        p++;
+    }
+    if (!n.signal && x.len() > 0) {
+        *--p = '-';
+    }
+    os.write(p, end - p);
+    return os;
+}
+
+// ===================================
+// Powers and Montgomery arithmetic
+// ===================================
+
+int2048 pow(const int2048 &a, long long e) {
+    if (e < 0) {
+        throw std::domain_error("int2048: negative exponent");
+    }
+    int2048 r(1);
+    int2048 base(a);
+    while (e) {
+        if (e & 1) {
+            r *= base;
+        }
+        e >>= 1;
+        if (e) {
+            base *= base;
+        }
+    }
+    return r;
+}
+
+// Number of significant bits of |e|.
+int bitLength(const int2048 &e) {
+    int n = e.len();
+    if (n == 0) {
+        return 0;
+    }
+    return 32 * n - leadingZeros(e.digits[n - 1]);
+}
+
+// Bit i of |e|, for 0 <= i < bitLength(e).
+bool testBit(const int2048 &e, int i) {
+    return (e.digits[i / 32] >> (i % 32)) & 1;
+}
+
+MontgomeryContext::MontgomeryContext(const int2048 &m) {
+    modulus = int2048(m.digits, true);
+    modulus.cut();
+    n = modulus.len();
+    if (n == 0 || !(modulus.digits[0] & 1) || modulus == int2048(1)) {
+        throw std::invalid_argument("int2048: Montgomery modulus must be odd and greater than 1");
+    }
+    unsigned inv = modulus.digits[0];
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - modulus.digits[0] * inv;
+    }
+    mInv = 0u - inv;
+    // lift m^-1 from one limb to n limbs: y <- y (2 - m y) mod 2^(64k)
+    int2048 y(inv);
+    for (int k = 1; k < n; k *= 2) {
+        int k2 = std::min(2 * k, n);
+        int2048 my = lowLimbs(lowLimbs(modulus, k2) * y, k2);
+        y = lowLimbs(y * ((int2048(1) << k2) + int2048(2) - my), k2);
+    }
+    mInvFull = y.len() == 0 ? y : (int2048(1) << n) - y;
+    one = (int2048(1) << n) % modulus;
+    r2 = (int2048(1) << (2 * n)) % modulus;
+}
+
+// Small moduli add u * m at each limb position, choosing u to clear that
+// limb (REDC one word at a time); large ones clear all n low limbs at once
+// with q = (x mod R) * (-m^-1) mod R, so the cost is two multiplications.
+int2048 MontgomeryContext::reduce(const int2048 &x) const {
+    int2048 t;
+    if (n < MONTGOMERY_THRESHOLD) {
+        t.digits.assign(2 * n + 1, 0);
+        std::copy(x.digits.begin(), x.digits.begin() + std::min(x.len(), 2 * n), t.digits.begin());
+        unsigned *r = t.digits.data();
+        const unsigned *m = modulus.digits.data();
+        for (int i = 0; i < n; i++) {
+            unsigned long long u = (unsigned)(r[i] * mInv);
+            unsigned long long carry = 0;
+            for (int j = 0; j < n; j++) {
+                carry += u * m[j] + r[i+j];
+                r[i+j] = (unsigned)carry;
+                carry >>= 32;
             }
-            os << n.digits[i];
-            for (int j = i-1; j >= 0; j--) {
-                if (n.digits[j] == 0) {
-                    os << "0000";
-                }
-                else if (n.digits[j]<10) {
-                    os << "000" << n.digits[j];
-                }
-                else if (n.digits[j]<100) {
-                    os << "00" << n.digits[j];
-                }
-                else if (n.digits[j]<1000) {
-                    os << "0" << n.digits[j];
-                }
-                else {
-                    os << n.digits[j];
-                }
+            for (int k = i + n; k <= 2 * n && carry; k++) {
+                carry += r[k];
+                r[k] = (unsigned)carry;
+                carry >>= 32;
             }
-            return os;
         }
+        t.digits.erase(t.digits.begin(), t.digits.begin() + n);
+        t.cut();
     }
-    os << '0';
-    return os;
+    else {
+        int2048 q = lowLimbs(lowLimbs(x, n) * mInvFull, n);
+        t = x;
+        addmul(t, q, modulus);
+        t = t >> n;
+    }
+    if (absCmp(t, modulus) >= 0) {
+        t -= modulus;
+    }
+    return t;
 }
 
-int2048 operator*(int2048 a, const int2048 & b) {
-    int2048 res;
-    res.signal = a.signal == b.signal;
-    res.digits.resize(a.digits.size() + b.digits.size());
-    for (int i = 0; i < b.digits.size(); i++) {
-        for (int j = 0; j < a.digits.size(); j++) {
-            res.digits[i+j] += a.digits[j] * b.digits[i];
-        }
-        int carry = 0;
-        for (int j = 0; j < res.digits.size(); j++) {
-            res.digits[j] += carry;
-            if (res.digits[j] >= 10000) {
-                carry = res.digits[j] / 10000;
-                res.digits[j] %= 10000;
-            }
-            else {
-                carry = 0;
+int2048 MontgomeryContext::toMont(const int2048 &x) const {
+    int2048 a(x);
+    if (!a.signal || absCmp(a, modulus) >= 0) {
+        a %= modulus;
+    }
+    return reduce(int2048(a * r2));
+}
+
+int2048 MontgomeryContext::fromMont(const int2048 &x) const {
+    return reduce(x);
+}
+
+int2048 MontgomeryContext::mul(const int2048 &a, const int2048 &b) const {
+    return reduce(int2048(a * b));
+}
+
+// Left-to-right sliding window over the bits of e, with the odd powers
+// x, x^3, ..., x^(2^w - 1) precomputed.
+int2048 MontgomeryContext::pow(const int2048 &a, const int2048 &e) const {
+    if (!e.signal && e.len() > 0) {
+        throw std::domain_error("int2048: negative exponent");
+    }
+    int bits = bitLength(e);
+    int w = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+    std::vector<int2048> odd(1 << (w - 1));
+    odd[0] = toMont(a);
+    if (w > 1) {
+        int2048 x2 = mul(odd[0], odd[0]);
+        for (std::size_t i = 1; i < odd.size(); i++) {
+            odd[i] = mul(odd[i-1], x2);
+        }
+    }
+    int2048 r = one;
+    int i = bits - 1;
+    while (i >= 0) {
+        if (!testBit(e, i)) {
+            r = mul(r, r);
+            i--;
+            continue;
+        }
+        int j = std::max(i - w + 1, 0);
+        while (!testBit(e, j)) {
+            j++;
+        }
+        int value = 0;
+        for (int k = i; k >= j; k--) {
+            value = value * 2 + testBit(e, k);
+            r = mul(r, r);
+        }
+        r = mul(r, odd[value >> 1]);
+        i = j - 1;
+    }
+    return fromMont(r);
+}
+
+int2048 powmod(const int2048 &a, const int2048 &e, const int2048 &m) {
+    if (!e.signal && e.len() > 0) {
+        throw std::domain_error("int2048: negative exponent");
+    }
+    int2048 mod(m.digits, true);
+    mod.cut();
+    int2048 r;
+    if (mod.len() == 0) {
+        throw std::domain_error("int2048: zero modulus");
+    }
+    else if (mod == int2048(1)) {
+        r = int2048(0);
+    }
+    else if (mod.digits[0] & 1) {
+        r = MontgomeryContext(mod).pow(a, e);
+    }
+    else {
+        // even moduli have no Montgomery form; square and multiply with %
+        r = int2048(1);
+        int2048 base = a % mod;
+        for (int i = bitLength(e) - 1; i >= 0; i--) {
+            r = r * r % mod;
+            if (testBit(e, i)) {
+                r = r * base % mod;
             }
         }
-        if (carry) {
-            res.digits.push_back(carry);
+    }
+    if (!m.signal && r.len() > 0) {
+        r -= mod;
+    }
+    return r;
+}
+
+// ===================================
+// GCD
+// ===================================
+
+// A unimodular matrix with (x0, y0) = M (x, y), where (x0, y0) is the pair a
+// reduction started from and (x, y) the pair it has reached; det is +-1.
+struct GcdMatrix {
+    int2048 m[4];
+    int det;
+
+    GcdMatrix() : det(1) {
+        m[0] = int2048(1);
+        m[3] = int2048(1);
+    }
+};
+
+// M <- M N
+static void gcdMatrixMul(GcdMatrix &M, const GcdMatrix &N) {
+    for (int i = 0; i < 4; i += 2) {
+        int2048 c0 = M.m[i] * N.m[0];
+        int2048 c1 = M.m[i] * N.m[1];
+        addmul(c0, M.m[i + 1], N.m[2]);
+        addmul(c1, M.m[i + 1], N.m[3]);
+        M.m[i].swap(c0);
+        M.m[i + 1].swap(c1);
+    }
+    M.det *= N.det;
+}
+
+// One exact Euclidean step (x, y) <- (y, x mod y), i.e. M <- M [[q, 1], [1, 0]].
+static void gcdDivisionStep(int2048 &x, int2048 &y, GcdMatrix *M) {
+    int2048 q, r;
+    divmod(x, y, q, r);
+    x.swap(y);
+    y.swap(r);
+    if (M) {
+        for (int i = 0; i < 4; i += 2) {
+            addmul(M->m[i + 1], M->m[i], q);
+            M->m[i].swap(M->m[i + 1]);
         }
+        M->det = -M->det;
     }
-    
-    res.cut();
-    return res;
 }
 
-int2048 & int2048::operator/=(const int2048 & b) {
-    (*this) = (*this) / b;
-    return *this;
+// Bits [shift, shift + 62) of x >= 0.
+static long long topBits(const int2048 &x, int shift) {
+    long long v = 0;
+    for (int i = std::min(bitLength(x), shift + 62) - 1; i >= shift; i--) {
+        v = v * 2 + testBit(x, i);
+    }
+    return v;
 }
 
-int2048 operator/(int2048 a, const int2048 & b_) {
-    bool signal;
-    if (a.signal == b_.signal) {
-        signal = true;
+// One Lehmer step on x >= y > 0: Euclid runs on the leading 62 bits with
+// Jebelean's condition deciding how far the quotients are exact, which keeps
+// the cofactors below 2^31, and the resulting matrix is applied to the full
+// pair with two scalar multiply-adds per row. Stops early rather than take y
+// below s limbs. Returns false if not even one quotient was determined.
+static bool gcdLehmerStep(int2048 &x, int2048 &y, GcdMatrix *M, int s) {
+    int shift = std::max(bitLength(x) - 62, 0);
+    long long u = topBits(x, shift), v = topBits(y, shift);
+    int floorBits = LIMB_BITS * s - shift;
+    long long lowest = floorBits <= 0 ? 0 : 1ll << std::min(floorBits, 62);
+    long long A = 1, B = 0, C = 0, D = 1;
+    int k = 0;
+    for (;; k++) {
+        if (v - C == 0) {
+            break;
+        }
+        long long q = (u + (A - 1)) / (v - C);
+        long long t = u - q * v, w = B + q * D;
+        if (w > t || t < lowest) {
+            break;
+        }
+        u = v;
+        v = t;
+        t = A + q * C;
+        A = D;
+        B = C;
+        C = w;
+        D = t;
+    }
+    if (k == 0) {
+        return false;
+    }
+    // (x', y') = L (x, y) with L = [[A, -B], [-C, D]] after an even number
+    // of steps and [[-B, A], [D, -C]] after an odd one
+    long long l[4] = {A, -B, -C, D};
+    if (k & 1) {
+        l[0] = -B, l[1] = A, l[2] = D, l[3] = -C;
+    }
+    int2048 nx = x * l[0], ny = x * l[2];
+    addmul(nx, y, l[1]);
+    addmul(ny, y, l[3]);
+    x.swap(nx);
+    y.swap(ny);
+    if (M) {
+        // M <- M L^-1, L^-1 = det(L) [[l3, -l1], [-l2, l0]]
+        int detL = l[0] * l[3] - l[1] * l[2] > 0 ? 1 : -1;
+        long long inv[4] = {detL * l[3], -detL * l[1], -detL * l[2], detL * l[0]};
+        for (int i = 0; i < 4; i += 2) {
+            int2048 c0 = M->m[i] * inv[0], c1 = M->m[i] * inv[1];
+            addmul(c0, M->m[i + 1], inv[2]);
+            addmul(c1, M->m[i + 1], inv[3]);
+            M->m[i].swap(c0);
+            M->m[i + 1].swap(c1);
+        }
+        M->det *= detL;
+    }
+    return true;
+}
+
+static void gcdReduce(int2048 &x, int2048 &y, GcdMatrix *M, int s);
+
+// Half-GCD step on an m-limb pair: the top 2e limbs are reduced recursively
+// to about e limbs and the matrix doing so is applied to the whole pair,
+// which then loses about e limbs as well. The top limbs only approximate the
+// pair, so the last quotients may be off; the signs and order are repaired
+// (the matrix stays unimodular, so the gcd is unaffected) and the step is
+// rejected if it did not shrink the pair.
+static bool gcdHalfStep(int2048 &x, int2048 &y, GcdMatrix *M, int m, int e) {
+    int p = m - 2 * e;
+    int2048 xh = x >> p, yh = y >> p;
+    GcdMatrix N;
+    gcdReduce(xh, yh, &N, e + 1);
+    // (x', y') = N^-1 (x, y) = det(N) [[n3, -n1], [-n2, n0]] (x, y)
+    int2048 nx = N.m[3] * x;
+    int2048 ny = N.m[0] * y;
+    submul(nx, N.m[1], y);
+    submul(ny, N.m[2], x);
+    if (N.det < 0) {
+        nx = -nx;
+        ny = -ny;
+    }
+    if (nx < int2048(0)) {
+        nx = -nx;
+        N.m[0] = -N.m[0];
+        N.m[2] = -N.m[2];
+        N.det = -N.det;
+    }
+    if (ny < int2048(0)) {
+        ny = -ny;
+        N.m[1] = -N.m[1];
+        N.m[3] = -N.m[3];
+        N.det = -N.det;
+    }
+    if (nx < ny) {
+        nx.swap(ny);
+        N.m[0].swap(N.m[1]);
+        N.m[2].swap(N.m[3]);
+        N.det = -N.det;
+    }
+    if (nx.len() + ny.len() >= x.len() + y.len()) {
+        return false;
+    }
+    x.swap(nx);
+    y.swap(ny);
+    if (M) {
+        gcdMatrixMul(*M, N);
+    }
+    return true;
+}
+
+// Reduces x >= y >= 0 by Euclidean steps until y has at most s limbs (s = 0:
+// until y = 0), keeping x >= y and accumulating the steps into M if given.
+// Each round strips at most a third of the limbs, so a half step recurses on
+// at most two thirds of the pair and the whole costs O(M(n) log n).
+static void gcdReduce(int2048 &x, int2048 &y, GcdMatrix *M, int s) {
+    while (y.len() > s) {
+        int m = x.len();
+        if (y.len() + 1 < m) {
+            gcdDivisionStep(x, y, M);
+            continue;
+        }
+        int e = std::min(m - std::max(s, m / 2 + 1), m / 3);
+        if (e >= HGCD_THRESHOLD && gcdHalfStep(x, y, M, m, e)) {
+            continue;
+        }
+        if (!gcdLehmerStep(x, y, M, s)) {
+            gcdDivisionStep(x, y, M);
+        }
+    }
+}
+
+int2048 gcd(const int2048 &a, const int2048 &b) {
+    int2048 x(a), y(b);
+    x.signal = y.signal = true;
+    if (x < y) {
+        x.swap(y);
+    }
+    gcdReduce(x, y, nullptr, 0);
+    return x;
+}
+
+int2048 lcm(const int2048 &a, const int2048 &b) {
+    if (a.len() == 0 || b.len() == 0) {
+        return int2048(0);
+    }
+    int2048 r = a / gcd(a, b) * b;
+    r.signal = true;
+    return r;
+}
+
+// g = gcd(a, b) >= 0 with a s + b t = g; for b != 0, s is normalized into
+// [0, |b| / g), and gcd(0, 0) gives s = t = 0.
+int2048 xgcd(const int2048 &a, const int2048 &b, int2048 &s, int2048 &t) {
+    int2048 x(a), y(b);
+    x.signal = y.signal = true;
+    bool swapped = x < y;
+    if (swapped) {
+        x.swap(y);
+    }
+    GcdMatrix M;
+    gcdReduce(x, y, &M, 0);
+    // (|a|, |b|) = M (g, 0), so g = det(M) (m3 |a| - m1 |b|)
+    int2048 u = M.det > 0 ? M.m[3] : -M.m[3];
+    int2048 v = M.det > 0 ? -M.m[1] : M.m[1];
+    if (swapped) {
+        u.swap(v);
+    }
+    if (!a.signal) {
+        u = -u;
+    }
+    if (!b.signal) {
+        v = -v;
+    }
+    if (b.len() > 0 && x.len() > 0) {
+        int2048 step = b / x;
+        step.signal = true;
+        u %= step;
+        v = x;
+        submul(v, a, u);
+        v /= b;
+    }
+    else if (x.len() == 0) {
+        u = int2048(0);
+    }
+    s.swap(u);
+    t.swap(v);
+    return x;
+}
+
+// a^-1 mod m with the sign convention of operator%
+int2048 modinv(const int2048 &a, const int2048 &m) {
+    if (m.len() == 0) {
+        throw std::domain_error("int2048: zero modulus");
+    }
+    int2048 s, t;
+    if (xgcd(a % m, m, s, t) != int2048(1)) {
+        throw std::domain_error("int2048: not invertible");
+    }
+    return s % m;
+}
+
+// ===================================
+// Roots
+// ===================================
+
+static int2048 shiftLeftBits(const int2048 &x, int b) {
+    return (x << (b / LIMB_BITS)) * (1ll << (b % LIMB_BITS));
+}
+
+static int2048 shiftRightBits(const int2048 &x, int b) {
+    return (x >> (b / LIMB_BITS)) / (1ll << (b % LIMB_BITS));
+}
+
+// Roots of at most this many bits come straight from a floating estimate.
+static const int ROOT_BASE_BITS = 40;
+
+// floor(n^(1/k)) for n > 0 and 2 <= k < bitLength(n), possibly overestimated
+// by one or two. The root of the top bits of n is found recursively, shifted
+// into place and refined by a single Newton step, so each level doubles the
+// precision and the whole costs a few multiplications of the final size.
+static int2048 rootApprox(const int2048 &n, unsigned k) {
+    int bits = bitLength(n);
+    int m = (bits - 1) / k + 1;
+    if (m <= ROOT_BASE_BITS) {
+        int shift = std::max(bits - 53, 0);
+        double lead = std::log2((double)topBits(n, shift));
+        long long r = (long long)std::exp2((double)shift / k + lead / k);
+        r = std::max(r, 1ll);
+        while (r > 1 && pow(int2048(r), k) > n) {
+            r--;
+        }
+        while (pow(int2048(r + 1), k) <= n) {
+            r++;
+        }
+        return int2048(r);
+    }
+    // the shifted root is off by at most a few 2^h, and one Newton step
+    // squares that relative error: below one for this h
+    int kBits = 0;
+    while (kBits < 32 && (k >> kBits)) {
+        kBits++;
+    }
+    int h = (m - kBits - 5) / 2;
+    int2048 y = shiftLeftBits(rootApprox(shiftRightBits(n, k * h), k), h);
+    int2048 t = n / pow(y, k - 1);
+    addmul(t, y, (long long)k - 1);
+    return t / (long long)k;
+}
+
+int2048 isqrt(const int2048 &a) {
+    if (!a.signal && a.len() > 0) {
+        throw std::domain_error("int2048: square root of a negative number");
+    }
+    if (bitLength(a) <= 2) {
+        return int2048(a.len() > 0 ? 1 : 0);
+    }
+    int2048 r = rootApprox(a, 2), sq = r * r;
+    while (sq > a) {
+        sq -= r;
+        r -= 1;
+        sq -= r;
+    }
+    return r;
+}
+
+// Odd roots of negative numbers round toward zero.
+int2048 iroot(const int2048 &a, unsigned k) {
+    if (k == 0 || (!a.signal && a.len() > 0 && k % 2 == 0)) {
+        throw std::domain_error("int2048: no real root");
+    }
+    int2048 n(a.digits, true), r;
+    n.cut();
+    if (k == 1) {
+        r = n;
+    }
+    else if ((long long)k >= bitLength(n)) {
+        r = int2048(n.len() > 0 ? 1 : 0);
     }
     else {
-        signal = false;
+        r = rootApprox(n, k);
+        while (pow(r, k) > n) {
+            r -= 1;
+        }
     }
-    int2048 b(b_.digits, true);
-    a.signal = true;
-    int cmp = absCmp(b, int2048(10000));
-    if (cmp == 0) {
-        a.digits.erase(a.digits.begin());
-        if (a.digits.empty()) {
-            a.digits.push_back(0);
+    if (!a.signal) {
+        r = -r;
+    }
+    return r;
+}
+
+bool isPerfectSquare(const int2048 &a) {
+    if (!a.signal && a.len() > 0) {
+        return false;
+    }
+    // squares mod 64 and mod 63 * 65 * 11 reject most non-squares at once
+    static const unsigned long long SQUARES_MOD_64 = 0x0202021202030213ull;
+    if (a.len() > 0 && !((SQUARES_MOD_64 >> (a.digits[0] & 63)) & 1)) {
+        return false;
+    }
+    int2048 q;
+    long long r;
+    divmod(a, 45045, q, r);
+    for (int m : {63, 65, 11}) {
+        bool square = false;
+        for (int i = 0; i < m && !square; i++) {
+            square = i * i % m == r % m;
+        }
+        if (!square) {
+            return false;
         }
-        a.signal = signal;
-        return a;
     }
-    else if (cmp < 0) {
-        for (int i = a.digits.size()-1; i >= 0; i--) {
-            if (i > 0) {
-                a.digits[i-1] += a.digits[i] % b.digits[0] * 10000;
-            }
-            a.digits[i] /= b.digits[0];
+    int2048 root = isqrt(a);
+    return root * root == a;
+}
+
+// ===================================
+// Factorials and products
+// ===================================
+
+int2048 product(std::vector<int2048> v) {
+    if (v.empty()) {
+        return int2048(1);
+    }
+    // neighbours of one level have about the same size
+    for (int n = v.size(); n > 1; n = (n + 1) / 2) {
+        for (int i = 0; i < n / 2; i++) {
+            v[i] = v[2 * i] * v[2 * i + 1];
         }
-        a.signal = signal;
-        return a;
+        if (n & 1) {
+            v[n / 2].swap(v[n - 1]);
+        }
+    }
+    return std::move(v[0]);
+}
+
+// Product of the k in (lo, hi], only the odd ones if oddOnly. Factors are
+// packed into 63-bit leaves before the tree.
+static int2048 rangeProduct(long long lo, long long hi, bool oddOnly) {
+    std::vector<int2048> leaves;
+    long long step = oddOnly ? 2 : 1, k = lo + 1;
+    if (oddOnly && k % 2 == 0) {
+        k++;
     }
-    int2048 l(0);
-    int2048 r = a / int2048(10000);
-    int2048 mid, ans = l;
-    while (l <= r) {
-        mid = (l + r) / int2048(2);
-        if (mid * b > a) {
-            r = mid - 1;
+    unsigned long long leaf = 1;
+    for (; k <= hi; k += step) {
+        if (leaf > (unsigned long long)LLONG_MAX / k) {
+            leaves.push_back(int2048((long long)leaf));
+            leaf = 1;
         }
-        else {
-            l = mid + 1;
-            ans = mid;
+        leaf *= k;
+    }
+    leaves.push_back(int2048((long long)leaf));
+    return product(std::move(leaves));
+}
+
+// n! = 2^(n - popcount(n)) * prod_i oddPart(n >> i), where oddPart(m) is the
+// product of the odd numbers up to m (split recursive): going down from the
+// top, p extends to the next oddPart and the partial result takes p in,
+// so every multiplication is between operands of similar size.
+int2048 factorial(long long n) {
+    if (n < 0) {
+        throw std::domain_error("int2048: factorial of a negative number");
+    }
+    int2048 r(1), p(1);
+    int top = 0;
+    while ((n >> top) > 1) {
+        top++;
+    }
+    for (int i = top; i >= 0; i--) {
+        p *= rangeProduct(n >> (i + 1), n >> i, true);
+        r *= p;
+    }
+    int twos = 0;
+    for (long long m = n; m > 1; m >>= 1) {
+        twos += m >> 1;
+    }
+    return shiftLeftBits(r, twos);
+}
+
+int2048 binomial(long long n, long long k) {
+    if (k < 0) {
+        return int2048(0);
+    }
+    if (n < 0) {
+        int2048 r = binomial(k - n - 1, k);
+        return k & 1 ? -r : r;
+    }
+    if (k > n) {
+        return int2048(0);
+    }
+    k = std::min(k, n - k);
+    return rangeProduct(n - k, n, false) / factorial(k);
+}
+
+// ===================================
+// Batch operations
+// ===================================
+
+// The arena of the calling thread, created on its first batch.
+static LimbArena &batchArena() {
+    static thread_local LimbArena arena;
+    return arena;
+}
+
+// Runs op(i) for i < n in chunks claimed by the pool's threads. Temporaries
+// come from the running thread's arena, which is rewound after every
+// operation; op stores its results with batchStore, so no output ever
+// ends up holding arena memory.
+template <class Op>
+static void batchRun(int n, const Op &op) {
+    int chunks = std::min(n, threadCount * 16);
+    std::exception_ptr error;
+    Mutex errorLock;
+    parallelFor(chunks, [&](int c) {
+        LimbArena &arena = batchArena();
+        ScopedLimbResource use(&arena);
+        try {
+            for (int i = (long long)n * c / chunks; i < (long long)n * (c + 1) / chunks; i++) {
+                op(i);
+                arena.rewind();
+            }
+        }
+        catch (...) {
+            arena.rewind();
+            MutexLock guard(errorLock);
+            if (!error) {
+                error = std::current_exception();
+            }
         }
+    });
+    if (error) {
+        std::rethrow_exception(error);
     }
-    ans.signal = signal;
-    return ans;
 }
 
-int2048 & int2048::operator%=(const int2048 & b) {
-    *this = *this - (*this / b) * b;
-    return *this;   
+// Copies a result into a batch output; if the output has to grow, its new
+// buffer comes from outputs, the resource of the thread that started the
+// batch, instead of the running thread's arena.
+static void batchStore(int2048 &out, const int2048 &value, LimbResource *outputs) {
+    ScopedLimbResource use(outputs);
+    out = value;
 }
 
-int2048 operator%(int2048 a, const int2048 & b) {
-    a %= b;
-    return a;
+void batchAdd(const int2048 *a, const int2048 *b, int2048 *out, int n) {
+    LimbResource *outputs = limbResource;
+    batchRun(n, [&](int i) {
+        int2048 s(a[i]);
+        s += b[i];
+        batchStore(out[i], s, outputs);
+    });
+}
+
+void batchMul(const int2048 *a, const int2048 *b, int2048 *out, int n) {
+    LimbResource *outputs = limbResource;
+    batchRun(n, [&](int i) {
+        batchStore(out[i], multiply(a[i], b[i]), outputs);
+    });
+}
+
+void batchDivmod(const int2048 *a, const int2048 *b, int2048 *q, int2048 *r, int n) {
+    LimbResource *outputs = limbResource;
+    batchRun(n, [&](int i) {
+        int2048 tq, tr;
+        floorDivmod(a[i], b[i], tq, tr);
+        batchStore(q[i], tq, outputs);
+        batchStore(r[i], tr, outputs);
+    });
+}
+
+
+// ===================================
+// Serialization
+// ===================================
+
+static const char SERIAL_MAGIC[4] = {'I', '2', 'K', 'B'};
+
+static bool littleEndianHost() {
+    const unsigned one = 1;
+    return *(const unsigned char *)&one == 1;
+}
+
+static void storeLittleEndian(char *p, unsigned long long v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (char)(v >> (8 * i));
+    }
+}
+
+static unsigned long long loadLittleEndian(const char *p, int bytes) {
+    unsigned long long v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = v << 8 | (unsigned char)p[i];
+    }
+    return v;
+}
+
+// Validates the encoding at [data, data + size) and returns its limb count.
+static int serialLimbs(const char *data, std::size_t size, bool &negative) {
+    if (size < (std::size_t)SERIAL_HEADER_BYTES || std::memcmp(data, SERIAL_MAGIC, 4) != 0) {
+        throw std::invalid_argument("int2048: not a serialized value");
+    }
+    if (loadLittleEndian(data + 4, 2) != SERIAL_VERSION) {
+        throw std::invalid_argument("int2048: unsupported serialization version");
+    }
+    unsigned char sign = data[6];
+    unsigned long long n = loadLittleEndian(data + 8, 8);
+    const char *limbs = data + SERIAL_HEADER_BYTES;
+    if (sign > 1 || data[7] != 0 || n > INT_MAX || n > (size - SERIAL_HEADER_BYTES) / 4 ||
+        (n == 0 && sign) || (n > 0 && loadLittleEndian(limbs + 4 * (n - 1), 4) == 0)) {
+        throw std::invalid_argument("int2048: malformed serialized value");
+    }
+    negative = sign;
+    return n;
+}
+
+std::size_t serializedSize(const int2048 &x) {
+    return SERIAL_HEADER_BYTES + 4 * (std::size_t)x.len();
+}
+
+void serialize(const int2048 &x, char *out) {
+    int n = x.len();
+    std::memcpy(out, SERIAL_MAGIC, 4);
+    storeLittleEndian(out + 4, SERIAL_VERSION, 2);
+    out[6] = n > 0 && !x.signal;
+    out[7] = 0;
+    storeLittleEndian(out + 8, n, 8);
+    char *limbs = out + SERIAL_HEADER_BYTES;
+    if (littleEndianHost()) {
+        std::memcpy(limbs, x.digits.data(), 4 * (std::size_t)n);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        storeLittleEndian(limbs + 4 * i, x.digits[i], 4);
+    }
+}
+
+std::string serialize(const int2048 &x) {
+    std::string s(serializedSize(x), '\0');
+    serialize(x, &s[0]);
+    return s;
+}
+
+int2048 deserialize(const char *data, std::size_t size) {
+    bool negative;
+    int n = serialLimbs(data, size, negative);
+    const char *limbs = data + SERIAL_HEADER_BYTES;
+    int2048 r;
+    if (n == 0) {
+        return r;
+    }
+    r.digits.resize(n);
+    if (littleEndianHost()) {
+        std::memcpy(r.digits.data(), limbs, 4 * (std::size_t)n);
+    }
+    else {
+        for (int i = 0; i < n; i++) {
+            r.digits[i] = loadLittleEndian(limbs + 4 * i, 4);
+        }
+    }
+    r.signal = !negative;
+    return r;
+}
+
+int2048 deserialize(const std::string &s) {
+    return deserialize(s.data(), s.size());
+}
+
+void int2048_view::borrow(const unsigned *limbs, int n, bool signal) {
+    while (n > 0 && limbs[n - 1] == 0) {
+        n--;
+    }
+    source = limbs;
+    if (n > 0) {
+        value.digits = LimbVector::borrow(limbs, n);
+        value.signal = signal;
+    }
+}
+
+int2048_view::int2048_view(const unsigned *limbs, int n, bool signal) {
+    borrow(limbs, n, signal);
+}
+
+int2048_view::int2048_view(const char *data, std::size_t size) {
+    bool negative;
+    int n = serialLimbs(data, size, negative);
+    const char *limbs = data + SERIAL_HEADER_BYTES;
+    if (littleEndianHost() && (std::uintptr_t)limbs % alignof(unsigned) == 0) {
+        borrow((const unsigned *)limbs, n, !negative);
+    }
+    else {
+        source = nullptr;
+        value = deserialize(data, size);
+    }
+}
+
+int2048_view::int2048_view(const int2048_view &a) {
+    if (a.source) {
+        borrow(a.source, a.value.len(), a.value.signal);
+    }
+    else {
+        source = nullptr;
+        value = a.value;
+    }
 }
 
 } // namespace sjtu
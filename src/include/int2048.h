@@ -17,11 +17,278 @@
 
 // 请不要使用 using namespace std;
 
+// Beyond these the library uses only standard utility headers (<algorithm>,
+// <climits>, <cmath>, <cstdint>, <cstdlib>, <exception>, <stdexcept>,
+// <string>, <utility>); anything else is included only under a feature
+// macro, and the single-file build (build.h) defines none of them:
+//   INT2048_THREADS  the thread pool behind setThreadCount and batch*
+//   INT2048_SIMD     the SSE4.1 and AVX2 kernels behind setSimdLevel
+//   INT2048_STATS    the operation counters behind int2048::stats()
+//   INT2048_MMAP     MappedLimbResource (POSIX only)
+
 namespace sjtu {
-  static const int DIGIT_NUM = 4;
+  // Magnitudes are stored as little-endian 32-bit binary limbs; decimal
+  // conversion only happens in read() and operator<<. Limb counts are ints:
+  // an operation whose result would exceed INT_MAX limbs (8 GiB, about
+  // 2 * 10^10 decimal digits) throws std::length_error, as does reading more
+  // than INT_MAX decimal digits.
+  static const int LIMB_BITS = 32;
+  // operator* picks its algorithm by the shorter operand's limb count:
+  // schoolbook below KARATSUBA_THRESHOLD, Karatsuba up to NTT_THRESHOLD and
+  // NTT above; with the AVX2 transforms (setSimdLevel) the NTT already takes
+  // over at NTT_AVX2_THRESHOLD. All are measured crossovers (see
+  // mulKaratsuba/mulNtt).
+  static const int KARATSUBA_THRESHOLD = 48;
+  static const int NTT_THRESHOLD = 3072;
+  static const int NTT_AVX2_THRESHOLD = 512;
+  // Products longer than one NTT can hold (2^24 limbs together) are
+  // computed blockwise instead (mulStreaming), in blocks of up to
+  // STREAM_BLOCK limbs, with working memory of about 16 times the shorter
+  // operand that is swept block by block. Every pair of blocks is multiplied
+  // pointwise, so the time grows with the product of the operands' block
+  // counts: out-of-core sizes are practical for one long and one shorter
+  // operand, not for two balanced ones of many blocks each.
+  static const int STREAM_BLOCK = 1 << 20;
+  // With DIVISION_AUTO, operator/ uses Algorithm D until both the divisor and
+  // the quotient reach BZ_THRESHOLD limbs, Burnikel-Ziegler up to a divisor
+  // of NEWTON_THRESHOLD limbs and Newton reciprocal division beyond that.
+  // BZ_BASE and NEWTON_BASE are the sizes at which those recursions stop.
+  // All four are measured crossovers; on 32-bit limbs Burnikel-Ziegler still
+  // beats Newton at 2^18 limbs, so Newton only takes over near the NTT limit.
+  static const int BZ_THRESHOLD = 384;
+  static const int BZ_BASE = 32;
+  static const int NEWTON_THRESHOLD = 1 << 20;
+  static const int NEWTON_BASE = 16;
+  // MontgomeryContext reduces word by word below this many limbs and with
+  // two multiplications by a precomputed inverse above it (measured).
+  static const int MONTGOMERY_THRESHOLD = 256;
+  // With more than one thread (setThreadCount), Karatsuba products of at
+  // least PARALLEL_THRESHOLD limbs run their three half products
+  // concurrently, and NTT products split every transform pass, the
+  // pointwise products and the CRT recombination. Results are identical for
+  // every thread count.
+  static const int PARALLEL_THRESHOLD = 1024;
+  // gcd and xgcd take Lehmer steps until a round can strip this many limbs,
+  // and half-GCD steps from there (measured).
+  static const int HGCD_THRESHOLD = 64;
+
+  // Algorithm used by operator/ and operator%; DIVISION_AUTO picks by size.
+  enum DivisionStrategy {
+    DIVISION_AUTO,
+    DIVISION_SCHOOLBOOK,
+    DIVISION_NEWTON,
+    DIVISION_BURNIKEL_ZIEGLER
+  };
+  void setDivisionStrategy(DivisionStrategy);
+
+  // Process-wide number of threads for large multiplications (and through
+  // them divisions); 1, the default, keeps everything on the calling thread
+  // and 0 means std::thread::hardware_concurrency(). Set it while no
+  // arithmetic is running. Worker threads allocate from the default heap,
+  // never from the caller's LimbResource. Without INT2048_THREADS the count
+  // is always 1 and setThreadCount does nothing.
+  void setThreadCount(int);
+  int getThreadCount();
+
+  // Instruction set of the limb kernels behind addition, subtraction,
+  // comparison and multiplication by a single limb. The best level the CPU
+  // supports is picked at startup. setSimdLevel switches levels, clamped to
+  // what the CPU supports; set it while no arithmetic is running. Every
+  // level gives identical results. Without INT2048_SIMD (or off x86) only
+  // SIMD_SCALAR is supported.
+  enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE41,
+    SIMD_AVX2
+  };
+  void setSimdLevel(SimdLevel);
+  SimdLevel getSimdLevel();
+
+  // Operations and algorithm tiers counted by int2048::stats(). The tiers
+  // nest inside the operations and inside each other (a Burnikel-Ziegler
+  // division runs schoolbook divisions and Karatsuba products), and each
+  // row's cycles include everything its calls ran.
+  enum StatKind {
+    STAT_ADD,
+    STAT_SUB,
+    STAT_MUL,
+    STAT_DIV,
+    STAT_READ,
+    STAT_WRITE,
+    STAT_MUL_SCHOOLBOOK,
+    STAT_MUL_KARATSUBA,
+    STAT_MUL_NTT,
+    STAT_MUL_STREAMING,
+    STAT_DIV_SCHOOLBOOK,
+    STAT_DIV_BURNIKEL_ZIEGLER,
+    STAT_DIV_NEWTON,
+    STAT_KINDS
+  };
+  const char *statName(StatKind);
+
+  // Counters are only kept when the library is compiled with INT2048_STATS
+  // defined; otherwise nothing is counted, enabled is false and every
+  // counter stays zero. limbs adds up the operands' limb counts (the
+  // result's for read), and cycles is TSC ticks on x86 and nanoseconds
+  // elsewhere (recursive calls of one kind are timed once). allocations and
+  // allocatedBytes count the limb buffers LimbVector obtains, from the heap
+  // or a LimbResource.
+  struct StatCounter {
+    long long calls;
+    long long limbs;
+    long long cycles;
+  };
+  struct int2048Stats {
+    bool enabled;
+    StatCounter counters[STAT_KINDS];
+    long long allocations;
+    long long allocatedBytes;
+  };
+
+  // Source of heap memory for limb buffers. Without a resource LimbVector
+  // uses new[] / delete[]. While a resource is installed (see
+  // ScopedLimbResource), every LimbVector that outgrows its inline limbs on
+  // the same thread takes its heap buffer from it; later buffers of that
+  // vector come from the same resource, and each buffer goes back to the
+  // resource it came from.
+class LimbResource {
+public:
+  virtual ~LimbResource() {}
+  virtual unsigned *allocate(int) = 0;
+  virtual void deallocate(unsigned *, int) = 0;
+};
+  LimbResource *getLimbResource();
+  LimbResource *setLimbResource(LimbResource *);
+
+  // Bump allocator for scoped computations: allocating is a pointer bump in
+  // the current chunk, deallocating only reclaims the most recent buffer,
+  // and release() frees every chunk at once. Values whose buffers live in
+  // the arena must not outlive it; copy results out before releasing.
+class LimbArena : public LimbResource {
+  std::vector<unsigned *> chunks;
+  int chunkLimbs;
+  int capacity;
+  unsigned *top;
+  int left;
+public:
+  explicit LimbArena(int = 1 << 16);
+  ~LimbArena();
+  unsigned *allocate(int);
+  void deallocate(unsigned *, int);
+  void release();
+  // Makes every limb free again without returning memory to the heap, so
+  // a repeated computation of bounded size stops allocating after one round.
+  void rewind();
+};
+
+#ifdef INT2048_MMAP
+  // Keeps every buffer of at least minLimbs limbs in its own memory-mapped
+  // file in directory (created and unlinked at once, so nothing is left
+  // behind) and smaller ones on the heap. With it installed, values and the
+  // temporaries of operations on them can outgrow RAM and are paged to disk
+  // by the OS; the blockwise products of huge values sweep their buffers
+  // sequentially, so they slow down to disk bandwidth rather than failing.
+  // Throws std::system_error when a file cannot be created, sized or
+  // mapped. Only the installing thread uses it (worker threads allocate from
+  // the heap), and values allocated from it must not outlive it.
+class MappedLimbResource : public LimbResource {
+  std::string directory;
+  int minLimbs;
+  long long mapped;
+  long long peak;
+public:
+  explicit MappedLimbResource(const std::string & = "/tmp", int = 1 << 18);
+  unsigned *allocate(int);
+  void deallocate(unsigned *, int);
+  // bytes currently mapped, and the most ever mapped at once
+  long long mappedBytes() const { return mapped; }
+  long long peakMappedBytes() const { return peak; }
+};
+#endif
+
+  // Installs a resource for the current thread until the end of the scope.
+class ScopedLimbResource {
+  LimbResource *previous;
+public:
+  explicit ScopedLimbResource(LimbResource *);
+  ScopedLimbResource(const ScopedLimbResource &) = delete;
+  ScopedLimbResource &operator=(const ScopedLimbResource &) = delete;
+  ~ScopedLimbResource();
+};
+
+  // Limb storage for int2048. Up to SMALL_LIMBS limbs live inside the object
+  // (sharing space with the heap buffer and the resource it came from) and
+  // only larger values spill to the heap, so values up to 128 bits never
+  // allocate, and an int2048 stays at 32 bytes (int2048.cpp asserts it).
+  // Offers the subset of the std::vector interface int2048 uses.
+  static const int SMALL_LIMBS = 4;
+class LimbVector {
+  struct HeapBuffer {
+    unsigned *limbs;
+    LimbResource *resource;
+  };
+  int count;
+  int cap;
+  union {
+    HeapBuffer heap;
+    unsigned local[SMALL_LIMBS];
+  };
+  void grow(int);
+  void take(LimbVector &) noexcept;
+  // A vector over n limbs it does not own (copied inline when they fit), for
+  // int2048_view; it never frees them and must never be modified.
+  static LimbVector borrow(const unsigned *, int);
+  friend class int2048_view;
+public:
+  LimbVector();
+  explicit LimbVector(int, unsigned = 0);
+  LimbVector(const LimbVector &);
+  LimbVector(LimbVector &&) noexcept;
+  ~LimbVector();
+  LimbVector &operator=(const LimbVector &);
+  LimbVector &operator=(LimbVector &&) noexcept;
+  void swap(LimbVector &) noexcept;
+
+  int size() const { return count; }
+  bool empty() const { return count == 0; }
+  int capacity() const { return cap; }
+  unsigned *data() { return cap > SMALL_LIMBS ? heap.limbs : local; }
+  const unsigned *data() const { return cap > SMALL_LIMBS ? heap.limbs : local; }
+  unsigned *begin() { return data(); }
+  unsigned *end() { return data() + count; }
+  const unsigned *begin() const { return data(); }
+  const unsigned *end() const { return data() + count; }
+  unsigned &operator[](int i) { return data()[i]; }
+  unsigned operator[](int i) const { return data()[i]; }
+  unsigned &back() { return data()[count - 1]; }
+  unsigned back() const { return data()[count - 1]; }
+
+  void reserve(int);
+  void resize(int, unsigned = 0);
+  void assign(int, unsigned);
+  void push_back(unsigned);
+  void pop_back() { count--; }
+  void insert(unsigned *, int, unsigned);
+  void erase(unsigned *, unsigned *);
+};
+
+class int2048_view;
+
+  // Binary encoding of an int2048, little-endian throughout:
+  //   bytes 0-3   magic "I2KB"
+  //   bytes 4-5   format version (SERIAL_VERSION)
+  //   byte  6     1 for negative values, 0 otherwise
+  //   byte  7     zero
+  //   bytes 8-15  limb count n
+  //   then n 32-bit limbs, least significant first, the top one nonzero.
+  // The limbs start 16 bytes in, so they stay 4-byte aligned wherever the
+  // encoding itself is.
+  static const int SERIAL_VERSION = 1;
+  static const int SERIAL_HEADER_BYTES = 16;
+
 class int2048 {
   // todo
-  std::vector<int> digits;
+  LimbVector digits;
   bool signal; // true for positive, false for negative
 public:
   // 构造函数
@@ -29,7 +296,9 @@ public:
   int2048(long long);
   int2048(const std::string &);
   int2048(const int2048 &);
-  int2048(const std::vector<int>&, bool);
+  int2048(int2048 &&) noexcept;
+  int2048(const std::vector<unsigned>&, bool);
+  int2048(const LimbVector &, bool);
 
   // 以下给定函数的形式参数类型仅供参考，可自行选择使用常量引用或者不使用引用
   // 如果需要，可以自行增加其他所需的函数
@@ -38,16 +307,26 @@ public:
   // ===================================
 
   int len() const;
-  friend int absCmp(const int2048 &, const int2048 &, int);
   friend int absCmp(const int2048 &, const int2048 &);
   void cut();
-  friend int divide_(int2048 &, const int2048 &, int);
+  void addSigned(const int2048 &, bool);
+  friend void absDivmodSchoolbook(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void absDivmodNewton(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void absDivmodBurnikelZiegler(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void absDivmod(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void floorDivmod(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend int2048 reciprocal(const int2048 &);
 
   // 读入一个大整数
   void read(const std::string &);
   // 输出储存的大整数，无需换行
   void print();
 
+  // Snapshot of the process-wide counters (see int2048Stats), and a reset
+  // of all of them to zero.
+  static int2048Stats stats();
+  static void resetStats();
+
   // 加上一个大整数
   int2048 &add(const int2048 &);
   // 返回两个大整数之和
@@ -66,6 +345,9 @@ public:
   int2048 operator-() const;
 
   int2048 &operator=(const int2048 &);
+  int2048 &operator=(int2048 &&) noexcept;
+  void swap(int2048 &) noexcept;
+  friend void swap(int2048 &, int2048 &) noexcept;
 
   int2048 &operator+=(const int2048 &);
   friend int2048 operator+(const int2048 &, const int2048 &);
@@ -74,7 +356,50 @@ public:
   friend int2048 operator-(const int2048 &, const int2048 &);
 
   int2048 &operator*=(const int2048 &);
-  friend int2048 operator*(int2048, const int2048 &);
+  friend int2048 operator*(const int2048 &, const int2048 &);
+  friend int2048 multiply(const int2048 &, const int2048 &);
+  friend void mulAccumulate(int2048 &, const int2048 &, const int2048 &, bool);
+  friend void mulAccumulate(int2048 &, const int2048 &, long long, bool);
+
+  // acc += x * y and acc -= x * y, written straight into acc's limbs
+  friend void addmul(int2048 &, const int2048 &, const int2048 &);
+  friend void submul(int2048 &, const int2048 &, const int2048 &);
+  friend void addmul(int2048 &, const int2048 &, long long);
+  friend void submul(int2048 &, const int2048 &, long long);
+  // q = a / b and r = a % b (floor semantics, as operator/ and operator%)
+  // from a single division
+  friend void divmod(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend void divmod(const int2048 &, long long, int2048 &, long long &);
+
+  friend int bitLength(const int2048 &);
+  friend bool testBit(const int2048 &, int);
+
+  // a^e for e >= 0
+  friend int2048 pow(const int2048 &, long long);
+  // a^e mod m for e >= 0, with the sign convention of operator%; odd moduli
+  // go through MontgomeryContext
+  friend int2048 powmod(const int2048 &, const int2048 &, const int2048 &);
+  friend class MontgomeryContext;
+
+  // gcd and lcm are nonnegative; xgcd returns g = gcd(a, b) and sets s, t
+  // with a s + b t = g; modinv follows the sign convention of operator% and
+  // throws std::domain_error when a is not invertible modulo m
+  friend int2048 gcd(const int2048 &, const int2048 &);
+  friend int2048 lcm(const int2048 &, const int2048 &);
+  friend int2048 xgcd(const int2048 &, const int2048 &, int2048 &, int2048 &);
+  friend int2048 modinv(const int2048 &, const int2048 &);
+
+  // floor(sqrt(a)) and floor(a^(1/k)) for a >= 0, with odd k also taking
+  // a < 0 (rounding toward zero); std::domain_error otherwise
+  friend int2048 isqrt(const int2048 &);
+  friend int2048 iroot(const int2048 &, unsigned);
+  friend bool isPerfectSquare(const int2048 &);
+  friend int2048 mulSchoolbook(const int2048 &, const int2048 &);
+  friend int2048 mulKaratsuba(const int2048 &, const int2048 &);
+  friend int2048 mulNtt(const int2048 &, const int2048 &);
+  // blockwise NTT product in blocks of at most the given number of limbs
+  // (a power of two; operator* passes STREAM_BLOCK)
+  friend int2048 mulStreaming(const int2048 &, const int2048 &, int);
 
   int2048 &operator/=(const int2048 &);
   friend int2048 operator/(int2048, const int2048 &);
@@ -82,9 +407,29 @@ public:
   int2048 &operator%=(const int2048 &);
   friend int2048 operator%(int2048, const int2048 &);
 
+  // scalar forms: one pass over the limbs, no temporary int2048
+  int2048 &operator*=(long long);
+  int2048 &operator/=(long long);
+  int2048 &operator%=(long long);
+  friend int2048 operator*(int2048, long long);
+  friend int2048 operator*(long long, int2048);
+  friend int2048 operator/(int2048, long long);
+  friend int2048 operator%(int2048, long long);
+
+  friend void writeDecimal(const int2048 &, char *, char *);
   friend std::istream &operator>>(std::istream &, int2048 &);
+  // serialize writes serializedSize(x) bytes; deserialize throws
+  // std::invalid_argument on anything but a well-formed encoding of a
+  // supported version, and ignores bytes after the encoded value
+  friend std::size_t serializedSize(const int2048 &);
+  friend void serialize(const int2048 &, char *);
+  friend std::string serialize(const int2048 &);
+  friend int2048 deserialize(const char *, std::size_t);
+  friend int2048 deserialize(const std::string &);
+  friend class int2048_view;
   friend std::ostream &operator<<(std::ostream &, const int2048 &);
   friend int2048 operator<<(int2048, int);
+  friend int2048 operator>>(int2048, int);
 
   friend bool operator==(const int2048 &, const int2048 &);
   friend bool operator!=(const int2048 &, const int2048 &);
@@ -93,6 +438,106 @@ public:
   friend bool operator<=(const int2048 &, const int2048 &);
   friend bool operator>=(const int2048 &, const int2048 &);
 };
+
+// Montgomery arithmetic modulo a fixed odd modulus m > 1, with R = 2^(32n)
+// for an n-limb m. All reduction constants are computed once in the
+// constructor; afterwards mul() and pow() never divide.
+class MontgomeryContext {
+  int2048 modulus;
+  int n;
+  unsigned mInv;     // -m^-1 mod 2^32
+  int2048 mInvFull;  // -m^-1 mod R
+  int2048 r2;        // R^2 mod m
+  int2048 one;       // R mod m
+public:
+  explicit MontgomeryContext(const int2048 &);
+  // x R^-1 mod m, for 0 <= x < m R
+  int2048 reduce(const int2048 &) const;
+  // x R mod m for any x, and back
+  int2048 toMont(const int2048 &) const;
+  int2048 fromMont(const int2048 &) const;
+  // a b R^-1 mod m, for a and b in Montgomery form
+  int2048 mul(const int2048 &, const int2048 &) const;
+  // a^e mod m for an ordinary (not Montgomery form) a and e >= 0
+  int2048 pow(const int2048 &, const int2048 &) const;
+};
+
+// A read-only int2048 over limbs that belong to someone else, such as a
+// serialized value in an mmap'd file. It converts to const int2048 &, so it
+// compares with and is an operand of every int2048 operator and function
+// without its limbs being copied (except by operators that take an operand
+// by value, as for any int2048). The limbs must not change or go away
+// while the view, or an expression using it, is alive.
+class int2048_view {
+  int2048 value;
+  const unsigned *source; // the borrowed limbs, null if value owns a copy
+  void borrow(const unsigned *, int, bool);
+public:
+  // n little-endian limbs with the given sign (true for nonnegative); high
+  // zero limbs are ignored
+  int2048_view(const unsigned *, int, bool = true);
+  // A serialized value (see SERIAL_VERSION). The limbs are borrowed when the
+  // host is little-endian and they are 4-byte aligned, and copied otherwise.
+  int2048_view(const char *, std::size_t);
+  // Borrows the same limbs again.
+  int2048_view(const int2048_view &);
+  int2048_view &operator=(const int2048_view &) = delete;
+
+  operator const int2048 &() const { return value; }
+  const int2048 &get() const { return value; }
+  bool borrowed() const { return source != nullptr; }
+};
+
+// n! for n >= 0, and the binomial coefficient C(n, k): zero for k < 0 or
+// k > n >= 0 and (-1)^k C(k - n - 1, k) for n < 0. Both multiply their
+// factors in balanced trees.
+int2048 factorial(long long);
+int2048 binomial(long long, long long);
+// out[i] = a[i] + b[i], out[i] = a[i] * b[i] and (q[i], r[i]) = divmod(a[i],
+// b[i]) for i < n, spread over getThreadCount() threads in dynamically
+// claimed chunks. Every thread runs its operations inside one LimbArena of
+// its own that is rewound after each operation, so once warm the only
+// allocations are outputs growing past their capacity. An output may alias
+// the inputs of its own index. An output that grows takes its buffer from
+// the resource of its current heap buffer, or else from the one installed on
+// the calling thread, which must be usable from any thread (the default
+// heap is). The first exception thrown by an operation is rethrown.
+void batchAdd(const int2048 *, const int2048 *, int2048 *, int);
+void batchMul(const int2048 *, const int2048 *, int2048 *, int);
+void batchDivmod(const int2048 *, const int2048 *, int2048 *, int2048 *, int);
+// The product of all values in a range, multiplied pairwise in a balanced
+// tree so that the large multiplications are between equal-sized operands.
+int2048 product(std::vector<int2048>);
+std::size_t serializedSize(const int2048 &);
+void serialize(const int2048 &, char *);
+std::string serialize(const int2048 &);
+int2048 deserialize(const char *, std::size_t);
+int2048 deserialize(const std::string &);
+template <class Iterator>
+int2048 product(Iterator begin, Iterator end) {
+  return product(std::vector<int2048>(begin, end));
+}
+
+// Namespace-scope declarations of the int2048 friends, so that they are
+// also found (through the implicit conversion) for int2048_view operands.
+int2048 operator+(const int2048 &, const int2048 &);
+int2048 operator-(const int2048 &, const int2048 &);
+int2048 operator*(const int2048 &, const int2048 &);
+int2048 operator/(int2048, const int2048 &);
+int2048 operator%(int2048, const int2048 &);
+int2048 operator*(int2048, long long);
+int2048 operator*(long long, int2048);
+int2048 operator/(int2048, long long);
+int2048 operator%(int2048, long long);
+std::ostream &operator<<(std::ostream &, const int2048 &);
+int2048 operator<<(int2048, int);
+int2048 operator>>(int2048, int);
+bool operator==(const int2048 &, const int2048 &);
+bool operator!=(const int2048 &, const int2048 &);
+bool operator<(const int2048 &, const int2048 &);
+bool operator>(const int2048 &, const int2048 &);
+bool operator<=(const int2048 &, const int2048 &);
+bool operator>=(const int2048 &, const int2048 &);
 } // namespace sjtu
 
 #endif